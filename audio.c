@@ -0,0 +1,716 @@
+#include "audio.h"
+#include "vfs.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define AUDIO_MAX_FRAMES 1024  // Largest batch of one run, with rate correction
+#define MAX_SFX 8
+#define SOUND_MAX_FRAMES (30 * AUDIO_SAMPLE_RATE)  // Longest sound effect, before and after resampling
+
+// Music streaming. The ring holds converted frames ready for mixing; each
+// run refills it with at most MUSIC_READS_PER_RUN chunks of source frames.
+#define MUSIC_RING_FRAMES 8192  // Power of two, 186 ms
+#define MUSIC_CHUNK_FRAMES 1024
+#define MUSIC_READS_PER_RUN 2
+
+// Streams are decoded one block at a time: up to PCM_BLOCK_FRAMES of PCM,
+// one IMA-ADPCM block or one QOA frame
+#define PCM_BLOCK_FRAMES 1024
+#define QOA_SLICE_LEN 20
+#define QOA_FRAME_LEN 5120
+#define STREAM_BLOCK_FRAMES QOA_FRAME_LEN
+#define STREAM_RAW_BYTES (8 + 2 * 16 + QOA_FRAME_LEN / QOA_SLICE_LEN * 2 * 8)  // A stereo QOA frame
+
+typedef enum {
+    CODEC_PCM,        // WAV format 1, 8 or 16-bit
+    CODEC_IMA_ADPCM,  // WAV format 0x11, 4 bits per sample
+    CODEC_QOA         // Quite OK Audio, 3.2 bits per sample
+} AudioCodec;
+
+// An open sound file, decoded to interleaved stereo at its own rate
+typedef struct {
+    FILE *fp;
+    AudioCodec codec;
+    int channels;
+    int sample_rate;
+    int bits_per_sample;  // PCM
+    int block_align;      // Bytes per IMA-ADPCM block
+    int frames;           // Whole file
+    long data_offset;     // Start of the encoded samples
+    long data_size;
+    long data_left;       // Encoded bytes not read yet
+    int16_t block[STREAM_BLOCK_FRAMES * 2];
+    int block_frames;
+    int block_pos;
+} AudioStream;
+
+// A sound ready for mixing: interleaved stereo at AUDIO_SAMPLE_RATE
+typedef struct {
+    int16_t *samples;
+    int frames;
+} Sound;
+
+typedef struct {
+    const Sound *sound;
+    int pos;     // Next frame to mix
+    int volume;  // 0-256
+} Voice;
+
+static Sound navigation;
+static int navigation_loaded = 0;  // 1 loaded, -1 missing or unreadable
+
+// Only the playing sound effects, packed at the front
+static Voice voices[MAX_SFX];
+static int voice_count = 0;
+
+// Menu music, streamed from the open file
+static AudioStream music;
+static int music_chunk_frames = 0;  // Source frames per read
+static int music_chunk_out = 0;     // Most output frames one read can produce
+static int music_volume = 128;
+
+// Resampler state carried between reads
+static uint32_t music_step = 0;   // Source frames per output frame, 16.16
+static uint32_t music_phase = 0;  // Position of the next output frame, 16.16
+static int16_t music_carry[2];    // Last source frame of the previous read
+static int music_have_carry = 0;
+
+static int16_t music_ring[MUSIC_RING_FRAMES * 2];
+static int music_ring_start = 0;
+static int music_ring_count = 0;
+
+static int16_t music_source[(MUSIC_CHUNK_FRAMES + 1) * 2];
+
+// Encoded bytes of the block being decoded
+static uint8_t stream_raw[STREAM_RAW_BYTES];
+
+static int32_t mix_buffer[AUDIO_MAX_FRAMES * 2];
+static int16_t out_buffer[AUDIO_MAX_FRAMES * 2];
+
+static int frame_accumulator = 0;  // Remainder of AUDIO_SAMPLE_RATE / AUDIO_FPS, in 1/AUDIO_FPS frames
+static int buffer_occupancy = -1;  // Frontend buffer level in percent, -1 when not reported
+
+static uint32_t read_le32(const uint8_t *p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static int read_le16(const uint8_t *p) {
+    return p[0] | (p[1] << 8);
+}
+
+static int read_be16(const uint8_t *p) {
+    return (p[0] << 8) | p[1];
+}
+
+static uint32_t read_be32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+static inline int clamp16(int sample) {
+    if (sample > 32767) return 32767;
+    if (sample < -32768) return -32768;
+    return sample;
+}
+
+// Mono streams decode into the left channel; copy it to the right
+static void block_mono_to_stereo(AudioStream *stream, int frames) {
+    if (stream->channels != 1) return;
+    for (int i = 0; i < frames; i++) stream->block[i * 2 + 1] = stream->block[i * 2];
+}
+
+// PCM
+
+static int pcm_decode_block(AudioStream *stream) {
+    int frame_size = stream->channels * stream->bits_per_sample / 8;
+    int frames = (int)(stream->data_left / frame_size);
+    if (frames > PCM_BLOCK_FRAMES) frames = PCM_BLOCK_FRAMES;
+    if (frames == 0) return 0;
+
+    frames = (int)vfs_fread(stream_raw, frame_size, frames, stream->fp);
+    stream->data_left -= (long)frames * frame_size;
+
+    for (int i = 0; i < frames; i++) {
+        for (int c = 0; c < stream->channels; c++) {
+            int index = i * stream->channels + c;
+            if (stream->bits_per_sample == 8) stream->block[i * 2 + c] = ((int)stream_raw[index] - 128) * 256;
+            else stream->block[i * 2 + c] = (int16_t)read_le16(stream_raw + index * 2);
+        }
+    }
+    block_mono_to_stereo(stream, frames);
+    return frames;
+}
+
+// IMA-ADPCM
+
+static const int16_t ima_steps[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442,
+    11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+    32767
+};
+
+static const int8_t ima_index_steps[8] = { -1, -1, -1, -1, 2, 4, 6, 8 };
+
+typedef struct {
+    int predictor;
+    int index;
+} ImaState;
+
+static inline int16_t ima_decode(ImaState *state, int nibble) {
+    int step = ima_steps[state->index];
+    int diff = step >> 3;
+    if (nibble & 1) diff += step >> 2;
+    if (nibble & 2) diff += step >> 1;
+    if (nibble & 4) diff += step;
+    state->predictor = clamp16(nibble & 8 ? state->predictor - diff : state->predictor + diff);
+
+    state->index += ima_index_steps[nibble & 7];
+    if (state->index < 0) state->index = 0;
+    if (state->index > 88) state->index = 88;
+    return (int16_t)state->predictor;
+}
+
+// Frames in an IMA-ADPCM block of the given size: the header sample plus
+// eight per four bytes of each channel
+static int ima_block_frames(int bytes, int channels) {
+    if (bytes < 4 * channels) return 0;
+    return 1 + (bytes - 4 * channels) / (4 * channels) * 8;
+}
+
+static int ima_decode_block(AudioStream *stream) {
+    int bytes = stream->data_left < stream->block_align ? (int)stream->data_left : stream->block_align;
+    int frames = ima_block_frames(bytes, stream->channels);
+    if (frames == 0 || (int)vfs_fread(stream_raw, 1, bytes, stream->fp) != bytes) return 0;
+    stream->data_left -= bytes;
+
+    // Each channel starts with its first sample and step index
+    ImaState state[2];
+    for (int c = 0; c < stream->channels; c++) {
+        state[c].predictor = (int16_t)read_le16(stream_raw + c * 4);
+        state[c].index = stream_raw[c * 4 + 2] > 88 ? 88 : stream_raw[c * 4 + 2];
+        stream->block[c] = (int16_t)state[c].predictor;
+    }
+
+    // Then groups of four bytes per channel, eight samples each, low nibble first
+    const uint8_t *p = stream_raw + stream->channels * 4;
+    for (int frame = 1; frame < frames; frame += 8) {
+        for (int c = 0; c < stream->channels; c++) {
+            int16_t *out = stream->block + frame * 2 + c;
+            for (int i = 0; i < 4; i++, p++) {
+                out[i * 4] = ima_decode(&state[c], *p & 15);
+                out[i * 4 + 2] = ima_decode(&state[c], *p >> 4);
+            }
+        }
+    }
+    block_mono_to_stereo(stream, frames);
+    return frames;
+}
+
+// QOA
+
+static const int qoa_scalefactors[16] = {
+    1, 7, 21, 45, 84, 138, 211, 304, 421, 562, 731, 928, 1157, 1419, 1715, 2048
+};
+
+// Dequantized residuals in quarters; QOA rounds scalefactor times these
+// away from zero
+static const int qoa_dequant_quarters[4] = { 3, 10, 18, 28 };
+
+static int qoa_dequant[16][8];
+
+typedef struct {
+    int history[4];
+    int weights[4];
+} QoaLms;
+
+static void qoa_init_tables(void) {
+    for (int s = 0; s < 16; s++) {
+        for (int q = 0; q < 4; q++) {
+            int value = (qoa_scalefactors[s] * qoa_dequant_quarters[q] + 2) / 4;
+            qoa_dequant[s][q * 2] = value;
+            qoa_dequant[s][q * 2 + 1] = -value;
+        }
+    }
+}
+
+static int qoa_decode_frame(AudioStream *stream) {
+    uint8_t *p = stream_raw;
+    if (stream->data_left < 8 || vfs_fread(p, 1, 8, stream->fp) != 8) return 0;
+
+    int channels = p[0];
+    int frames = read_be16(p + 4);
+    int size = read_be16(p + 6);
+    int slices = (frames + QOA_SLICE_LEN - 1) / QOA_SLICE_LEN;
+    if (channels != stream->channels || frames == 0 || frames > QOA_FRAME_LEN) return 0;
+    if (size != 8 + channels * 16 + slices * channels * 8 || size > stream->data_left) return 0;
+    if ((int)vfs_fread(p + 8, 1, size - 8, stream->fp) != size - 8) return 0;
+    stream->data_left -= size;
+    p += 8;
+
+    // Predictor state of each channel, big-endian 16-bit
+    QoaLms lms[2];
+    for (int c = 0; c < channels; c++, p += 16) {
+        for (int i = 0; i < 4; i++) {
+            lms[c].history[i] = (int16_t)read_be16(p + i * 2);
+            lms[c].weights[i] = (int16_t)read_be16(p + 8 + i * 2);
+        }
+    }
+
+    // Slices of 20 samples, interleaved by channel: a 4-bit scalefactor
+    // then 3-bit quantized residuals
+    for (int start = 0; start < frames; start += QOA_SLICE_LEN) {
+        int end = start + QOA_SLICE_LEN < frames ? start + QOA_SLICE_LEN : frames;
+        for (int c = 0; c < channels; c++, p += 8) {
+            uint64_t slice = ((uint64_t)read_be32(p) << 32) | read_be32(p + 4);
+            const int *dequant = qoa_dequant[slice >> 60];
+            QoaLms *state = &lms[c];
+            slice <<= 4;
+
+            for (int i = start; i < end; i++, slice <<= 3) {
+                int predicted = (state->weights[0] * state->history[0] + state->weights[1] * state->history[1] +
+                                 state->weights[2] * state->history[2] + state->weights[3] * state->history[3]) >> 13;
+                int residual = dequant[slice >> 61];
+                int sample = clamp16(predicted + residual);
+                stream->block[i * 2 + c] = (int16_t)sample;
+
+                int delta = residual >> 4;
+                for (int k = 0; k < 4; k++) state->weights[k] += state->history[k] < 0 ? -delta : delta;
+                state->history[0] = state->history[1];
+                state->history[1] = state->history[2];
+                state->history[2] = state->history[3];
+                state->history[3] = sample;
+            }
+        }
+    }
+    block_mono_to_stereo(stream, frames);
+    return frames;
+}
+
+// Streams
+
+// Walk the chunks of a WAV up to its samples, reading only the chunk
+// headers. Returns 1 for PCM or IMA-ADPCM the mixer can play.
+static int wav_read_header(AudioStream *stream, long size) {
+    uint8_t header[16];
+    int have_format = 0;
+    long pos = 12;
+    while (pos + 8 <= size) {
+        if (vfs_fseek(stream->fp, pos, SEEK_SET) != 0 || vfs_fread(header, 1, 8, stream->fp) != 8) return 0;
+        uint32_t chunk_size = read_le32(header + 4);
+        uint32_t available = (uint32_t)(size - pos - 8);
+
+        if (!memcmp(header, "data", 4) && have_format) {
+            // Files cut short still play up to where they end
+            if (chunk_size > available) chunk_size = available;
+            stream->data_offset = pos + 8;
+            stream->data_size = chunk_size;
+            if (stream->codec == CODEC_PCM) {
+                stream->frames = chunk_size / (stream->channels * stream->bits_per_sample / 8);
+            } else {
+                stream->frames = chunk_size / stream->block_align * ima_block_frames(stream->block_align, stream->channels) +
+                                 ima_block_frames(chunk_size % stream->block_align, stream->channels);
+            }
+            return stream->frames > 0;
+        }
+        if (chunk_size > available) return 0;
+
+        if (!memcmp(header, "fmt ", 4)) {
+            if (chunk_size < 16 || vfs_fread(header, 1, 16, stream->fp) != 16) return 0;
+            int format = read_le16(header);
+            stream->channels = read_le16(header + 2);
+            stream->sample_rate = read_le32(header + 4);
+            stream->block_align = read_le16(header + 12);
+            stream->bits_per_sample = read_le16(header + 14);
+            if (stream->channels < 1 || stream->channels > 2 || stream->sample_rate <= 0) return 0;
+
+            if (format == 1) {
+                if (stream->bits_per_sample != 8 && stream->bits_per_sample != 16) return 0;
+                stream->codec = CODEC_PCM;
+            } else if (format == 0x11) {
+                // Blocks must hold whole four-byte groups and fit the block buffers
+                int group = 4 * stream->channels;
+                if (stream->bits_per_sample != 4 || stream->block_align < group || stream->block_align % group) return 0;
+                if (stream->block_align > STREAM_RAW_BYTES ||
+                    ima_block_frames(stream->block_align, stream->channels) > STREAM_BLOCK_FRAMES) return 0;
+                stream->codec = CODEC_IMA_ADPCM;
+            } else {
+                return 0;
+            }
+            have_format = 1;
+        }
+
+        // Chunks are padded to an even size
+        pos += 8 + (long)chunk_size + (chunk_size & 1);
+    }
+    return 0;
+}
+
+// The QOA file header holds the frames per channel; channels and rate come
+// from the first frame header
+static int qoa_read_header(AudioStream *stream, const uint8_t *header, long size) {
+    uint8_t frame[8];
+    stream->frames = (int)read_be32(header + 4);
+    if (stream->frames <= 0 || vfs_fread(frame, 1, 8, stream->fp) != 8) return 0;
+
+    stream->codec = CODEC_QOA;
+    stream->channels = frame[0];
+    stream->sample_rate = (frame[1] << 16) | (frame[2] << 8) | frame[3];
+    stream->data_offset = 8;
+    stream->data_size = size - 8;
+    if (stream->channels < 1 || stream->channels > 2 || stream->sample_rate <= 0) return 0;
+
+    // No more frames than the file's slices can hold, 20 per 8 bytes of
+    // each channel
+    long max_frames = stream->data_size / (8 * stream->channels) * QOA_SLICE_LEN;
+    if (stream->frames > max_frames) stream->frames = (int)max_frames;
+    return stream->frames > 0;
+}
+
+static void stream_close(AudioStream *stream) {
+    if (stream->fp) {
+        vfs_fclose(stream->fp);
+        stream->fp = NULL;
+    }
+}
+
+// Go back to the first sample
+static int stream_rewind(AudioStream *stream) {
+    stream->data_left = stream->data_size;
+    stream->block_frames = 0;
+    stream->block_pos = 0;
+    return vfs_fseek(stream->fp, stream->data_offset, SEEK_SET) == 0;
+}
+
+// Open a .qoa or a PCM or IMA-ADPCM .wav, telling them apart by content
+static int stream_open_file(AudioStream *stream, const char *path) {
+    uint8_t header[12];
+    stream->fp = vfs_fopen(path, "rb");
+    if (!stream->fp) return 0;
+
+    vfs_fseek(stream->fp, 0, SEEK_END);
+    long size = vfs_ftell(stream->fp);
+    vfs_fseek(stream->fp, 0, SEEK_SET);
+
+    int ok = 0;
+    if (vfs_fread(header, 1, 12, stream->fp) == 12) {
+        if (!memcmp(header, "qoaf", 4)) {
+            if (qoa_dequant[0][0] == 0) qoa_init_tables();
+            vfs_fseek(stream->fp, 8, SEEK_SET);
+            ok = qoa_read_header(stream, header, size);
+        } else if (!memcmp(header, "RIFF", 4) && !memcmp(header + 8, "WAVE", 4)) {
+            ok = wav_read_header(stream, size);
+        }
+    }
+    if (!ok || !stream_rewind(stream)) {
+        stream_close(stream);
+        return 0;
+    }
+    return 1;
+}
+
+// Open base.qoa, or base.wav if there's no QOA version
+static int stream_open(AudioStream *stream, const char *base) {
+    char path[256];
+    snprintf(path, sizeof(path), "%s.qoa", base);
+    if (stream_open_file(stream, path)) return 1;
+    snprintf(path, sizeof(path), "%s.wav", base);
+    return stream_open_file(stream, path);
+}
+
+// Decode up to frames stereo frames, a block at a time. Returns fewer at
+// the end of the file or on a read error.
+static int stream_read(AudioStream *stream, int16_t *out, int frames) {
+    int got = 0;
+    while (got < frames) {
+        if (stream->block_pos >= stream->block_frames) {
+            switch (stream->codec) {
+            case CODEC_PCM: stream->block_frames = pcm_decode_block(stream); break;
+            case CODEC_IMA_ADPCM: stream->block_frames = ima_decode_block(stream); break;
+            case CODEC_QOA: stream->block_frames = qoa_decode_frame(stream); break;
+            }
+            stream->block_pos = 0;
+            if (stream->block_frames == 0) break;
+        }
+
+        int count = stream->block_frames - stream->block_pos;
+        if (count > frames - got) count = frames - got;
+        memcpy(out + got * 2, stream->block + stream->block_pos * 2, count * 2 * sizeof(int16_t));
+        stream->block_pos += count;
+        got += count;
+    }
+    return got;
+}
+
+// Sound effects
+
+// Resample stereo frames to AUDIO_SAMPLE_RATE with linear interpolation.
+// Returns 1 on success.
+static int sound_resample(const int16_t *source, int source_frames, int sample_rate, Sound *sound) {
+    uint64_t length = (uint64_t)source_frames * AUDIO_SAMPLE_RATE / sample_rate;
+    if (length == 0 || length > SOUND_MAX_FRAMES) return 0;
+    int frames = (int)length;
+
+    int16_t *samples = (int16_t*)malloc((size_t)frames * 2 * sizeof(int16_t));
+    if (!samples) return 0;
+
+    // Source position in 16.16 fixed point
+    uint64_t step = ((uint64_t)sample_rate << 16) / AUDIO_SAMPLE_RATE;
+    uint64_t pos = 0;
+    for (int i = 0; i < frames; i++, pos += step) {
+        int frame = (int)(pos >> 16);
+        int next = frame + 1 < source_frames ? frame + 1 : frame;
+        int frac = (int)(pos & 0xFFFF);
+        for (int channel = 0; channel < 2; channel++) {
+            int a = source[frame * 2 + channel];
+            int b = source[next * 2 + channel];
+            samples[i * 2 + channel] = (int16_t)(a + (((b - a) * frac) >> 16));
+        }
+    }
+
+    sound->samples = samples;
+    sound->frames = frames;
+    return 1;
+}
+
+// Decode a whole sound file. Only for short sounds, music is streamed.
+// Returns 1 on success.
+static int sound_load(const char *base, Sound *sound) {
+    AudioStream *stream = (AudioStream*)calloc(1, sizeof(AudioStream));
+    if (!stream) return 0;
+    if (!stream_open(stream, base)) {
+        free(stream);
+        return 0;
+    }
+
+    int16_t *source = NULL;
+    if (stream->frames <= SOUND_MAX_FRAMES) source = (int16_t*)malloc((size_t)stream->frames * 2 * sizeof(int16_t));
+    int frames = source ? stream_read(stream, source, stream->frames) : 0;
+    int sample_rate = stream->sample_rate;
+    stream_close(stream);
+    free(stream);
+
+    // Already at the output rate: the decoded frames are the sound
+    if (frames > 0 && sample_rate == AUDIO_SAMPLE_RATE) {
+        sound->samples = source;
+        sound->frames = frames;
+        return 1;
+    }
+
+    int ok = frames > 0 && sound_resample(source, frames, sample_rate, sound);
+    free(source);
+    return ok;
+}
+
+static void sound_free(Sound *sound) {
+    free(sound->samples);
+    sound->samples = NULL;
+    sound->frames = 0;
+}
+
+static void voice_start(const Sound *sound, int volume) {
+    if (voice_count >= MAX_SFX) return;
+
+    Voice *voice = &voices[voice_count++];
+    voice->sound = sound;
+    voice->pos = 0;
+    voice->volume = volume;
+}
+
+// Add samples scaled by volume to the mix. Sounds are already in the output
+// format, so this is the whole per-sample cost of a voice.
+static void mix_span(int32_t *mix, const int16_t *samples, int count, int volume) {
+    for (int i = 0; i < count; i += 2) {
+        mix[i] += (samples[i] * volume) >> 8;
+        mix[i + 1] += (samples[i + 1] * volume) >> 8;
+    }
+}
+
+// Mix up to frames of a voice. Returns 0 once it has finished.
+static int voice_mix(Voice *voice, int32_t *mix, int frames) {
+    int count = voice->sound->frames - voice->pos;
+    if (count > frames) count = frames;
+
+    mix_span(mix, voice->sound->samples + voice->pos * 2, count * 2, voice->volume);
+    voice->pos += count;
+    return voice->pos < voice->sound->frames;
+}
+
+// Music
+
+// Decode up to frames source frames, going back to the first sample at
+// the end of the file so the music loops. Returns the frames decoded.
+static int music_read(int16_t *out, int frames) {
+    int got = 0;
+    int rewound = 0;
+    while (got < frames) {
+        int count = stream_read(&music, out + got * 2, frames - got);
+        got += count;
+        if (count > 0) {
+            rewound = 0;
+        } else if (rewound++ || !stream_rewind(&music)) {
+            break;
+        }
+    }
+    return got;
+}
+
+// Decode one chunk and resample it into the ring. The last source frame
+// is kept for the next chunk, so interpolation runs across chunk
+// boundaries and across the loop point. Returns 0 if the file can't be read.
+static int music_fill_chunk(void) {
+    int count = 0;
+    if (music_have_carry) {
+        music_source[0] = music_carry[0];
+        music_source[1] = music_carry[1];
+        count = 1;
+    }
+    int frames = music_read(music_source + count * 2, music_chunk_frames);
+    if (frames == 0) return 0;
+    count += frames;
+
+    // Output frames between the first and last source frame of this chunk
+    int end = (music_ring_start + music_ring_count) & (MUSIC_RING_FRAMES - 1);
+    while ((int)(music_phase >> 16) + 1 < count) {
+        int frame = music_phase >> 16;
+        int frac = music_phase & 0xFFFF;
+        for (int channel = 0; channel < 2; channel++) {
+            int a = music_source[frame * 2 + channel];
+            int b = music_source[(frame + 1) * 2 + channel];
+            music_ring[end * 2 + channel] = (int16_t)(a + (((b - a) * frac) >> 16));
+        }
+        end = (end + 1) & (MUSIC_RING_FRAMES - 1);
+        music_ring_count++;
+        music_phase += music_step;
+    }
+
+    music_phase -= (uint32_t)(count - 1) << 16;
+    music_carry[0] = music_source[(count - 1) * 2];
+    music_carry[1] = music_source[(count - 1) * 2 + 1];
+    music_have_carry = 1;
+    return 1;
+}
+
+// Top up the ring with at most reads chunks. A read error stops the music
+// once the ring has played out. The reads aren't charged to the current
+// user action.
+static void music_refill(int reads) {
+    vfs_begin_background();
+    while (music.fp && reads-- > 0 && MUSIC_RING_FRAMES - music_ring_count >= music_chunk_out) {
+        if (!music_fill_chunk()) stream_close(&music);
+    }
+    vfs_end_background();
+}
+
+static int music_open(const char *base) {
+    if (!stream_open(&music, base)) return 0;
+
+    // A chunk's output must fit in a quarter of the ring, which limits the
+    // source frames per read for low sample rates
+    int max_frames = (int)((uint64_t)(MUSIC_RING_FRAMES / 4) * music.sample_rate / AUDIO_SAMPLE_RATE);
+    music_chunk_frames = MUSIC_CHUNK_FRAMES < max_frames ? MUSIC_CHUNK_FRAMES : max_frames;
+    if (music_chunk_frames < 1) music_chunk_frames = 1;
+    // Plus the carried frame and rounding of the 16.16 step
+    music_chunk_out = (int)((uint64_t)music_chunk_frames * AUDIO_SAMPLE_RATE / music.sample_rate) + 3;
+
+    music_step = (uint32_t)(((uint64_t)music.sample_rate << 16) / AUDIO_SAMPLE_RATE);
+    music_phase = 0;
+    music_have_carry = 0;
+    music_ring_start = 0;
+    music_ring_count = 0;
+    return 1;
+}
+
+// Mix up to frames of music from the ring. Plays silence rather than
+// waiting if the card fell behind.
+static void music_mix(int32_t *mix, int frames) {
+    int count = frames < music_ring_count ? frames : music_ring_count;
+    int first = MUSIC_RING_FRAMES - music_ring_start;
+    if (first > count) first = count;
+
+    mix_span(mix, music_ring + music_ring_start * 2, first * 2, music_volume);
+    mix_span(mix + first * 2, music_ring, (count - first) * 2, music_volume);
+    music_ring_start = (music_ring_start + count) & (MUSIC_RING_FRAMES - 1);
+    music_ring_count -= count;
+}
+
+// Output rate
+
+// Called by the frontend before each retro_run()
+static void RETRO_CALLCONV audio_buffer_status(bool active, unsigned occupancy, bool underrun_likely) {
+    if (!active) buffer_occupancy = -1;
+    else buffer_occupancy = underrun_likely ? 0 : (int)occupancy;
+}
+
+// Stereo frames to output this run. Averages exactly AUDIO_SAMPLE_RATE /
+// AUDIO_FPS (735), so the frontend buffer neither fills up nor drains;
+// when the frontend reports its buffer level the count is nudged by up
+// to 1% to hold the buffer half full.
+static int frames_this_run(void) {
+    frame_accumulator += AUDIO_SAMPLE_RATE;
+    int frames = frame_accumulator / AUDIO_FPS;
+    frame_accumulator -= frames * AUDIO_FPS;
+
+    if (buffer_occupancy >= 0) frames += frames * (50 - buffer_occupancy) / 5000;
+    return frames;
+}
+
+// Public API
+
+void audio_init(retro_environment_t environ_cb) {
+    struct retro_audio_buffer_status_callback buffer_status = { audio_buffer_status };
+    environ_cb(RETRO_ENVIRONMENT_SET_AUDIO_BUFFER_STATUS_CALLBACK, &buffer_status);
+
+    // Boot only waits for the first ring's worth, not the whole file
+    if (music_open(AUDIO_MUSIC_FILE)) music_refill(MUSIC_RING_FRAMES);
+}
+
+void audio_deinit(void) {
+    voice_count = 0;
+    stream_close(&music);
+    music_ring_count = 0;
+    sound_free(&navigation);
+    navigation_loaded = 0;
+}
+
+void audio_run(retro_audio_sample_batch_t batch_cb) {
+    if (!batch_cb) return;
+
+    music_refill(MUSIC_READS_PER_RUN);
+
+    int frames = frames_this_run();
+    int count = frames * 2;
+
+    if (voice_count == 0 && music_ring_count == 0) {
+        memset(out_buffer, 0, count * sizeof(int16_t));
+        batch_cb(out_buffer, frames);
+        return;
+    }
+
+    memset(mix_buffer, 0, count * sizeof(int32_t));
+    music_mix(mix_buffer, frames);
+    for (int i = 0; i < voice_count; ) {
+        if (voice_mix(&voices[i], mix_buffer, frames)) {
+            i++;
+        } else {
+            voices[i] = voices[--voice_count];
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        int32_t sample = mix_buffer[i];
+        sample = sample > 32767 ? 32767 : sample;
+        sample = sample < -32768 ? -32768 : sample;
+        out_buffer[i] = (int16_t)sample;
+    }
+    batch_cb(out_buffer, frames);
+}
+
+void audio_play_navigation(void) {
+    if (navigation_loaded == 0) {
+        navigation_loaded = sound_load(AUDIO_NAVIGATION_FILE, &navigation) ? 1 : -1;
+    }
+    if (navigation_loaded == 1) voice_start(&navigation, 128);
+}
@@ -0,0 +1,33 @@
+#ifndef AUDIO_H
+#define AUDIO_H
+
+#include <stdint.h>
+#include "libretro.h"
+
+// Menu music and navigation sound, mixed as interleaved 16-bit stereo at
+// the output rate. The navigation sound is decoded once when it is loaded;
+// the music is decoded a block at a time as it streams from the card
+// through a small ring buffer, so it can be any length without being read
+// into RAM. Files can be PCM or IMA-ADPCM WAV, or QOA.
+
+#define AUDIO_SAMPLE_RATE 44100
+#define AUDIO_FPS 60
+
+// Sounds without their extension: NAME.qoa is used if present, otherwise
+// NAME.wav, which can be PCM or IMA-ADPCM
+#define AUDIO_MUSIC_FILE "/mnt/sda1/frogui/menu_music"
+#define AUDIO_NAVIGATION_FILE "/mnt/sda1/frogui/navigation"
+
+// Register the frontend buffer status callback and start the menu music
+void audio_init(retro_environment_t environ_cb);
+
+// Free the loaded sounds and stop every voice
+void audio_deinit(void);
+
+// Mix one run's worth of audio and hand it to the frontend
+void audio_run(retro_audio_sample_batch_t batch_cb);
+
+// Play the navigation sound, loading it on first use
+void audio_play_navigation(void);
+
+#endif // AUDIO_H
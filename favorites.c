@@ -1,12 +1,241 @@
 #include "favorites.h"
+#include "vfs.h"
+#include "journal.h"
 #include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 #define FAVORITES_FILE "/mnt/sda1/frogui/favorites.txt"
+#define FAVORITES_TEMP_FILE "/mnt/sda1/frogui/favorites.txt.tmp"
+#define FAVORITES_JOURNAL "/mnt/sda1/frogui/favorites.log"
 
-// Favorites state
-static FavoriteGame favorites[MAX_FAVORITES];
+// Longest line in the favorites file or journal
+#define FAVORITES_LINE_SIZE 1024
+
+// A favorite's strings live in one pool and are referenced by offset, so
+// each favorite costs a few words plus its actual string lengths
+typedef struct {
+    uint32_t core_name;
+    uint32_t game_name;
+    uint32_t full_path;
+    uint32_t key;         // favorite_key(full_path, game_name)
+} Favorite;
+
+// Favorites state, in the order they were added
+static Favorite *favorites = NULL;
 static int favorite_count = 0;
+static int favorite_capacity = 0;
+
+static char *pool = NULL;
+static uint32_t pool_used = 0;
+static uint32_t pool_capacity = 0;
+static uint32_t pool_garbage = 0;  // Bytes of removed favorites
+
+// Open addressing index over (full_path, game_name), so checking a file
+// costs one hash instead of comparing against every favorite. Slots hold
+// a favorite index + 1, 0 is empty. The table is kept at least twice the
+// favorite capacity.
+static int *favorites_hash = NULL;
+static int hash_size = 0;
+
+// Cached orderings, rebuilt on first use after the list changes
+static int *orders[FAVORITES_SORT_COUNT];
+static bool order_valid[FAVORITES_SORT_COUNT];
+
+static const char *sort_names[FAVORITES_SORT_COUNT] = { "RECENT", "NAME", "SYSTEM" };
+
+// Records in the journal, so it can be folded back once it grows long
+static int journal_records = 0;
+
+static const char *pool_string(uint32_t offset) {
+    return pool + offset;
+}
+
+// FNV-1a over "directory/game_name"
+static uint32_t favorite_key(const char *directory, const char *game_name) {
+    uint32_t hash = 2166136261u;
+    for (const char *p = directory; *p; p++) hash = (hash ^ (unsigned char)*p) * 16777619u;
+    hash = (hash ^ '/') * 16777619u;
+    for (const char *p = game_name; *p; p++) hash = (hash ^ (unsigned char)*p) * 16777619u;
+    return hash;
+}
+
+static void index_favorite(int index) {
+    int slot = favorites[index].key & (hash_size - 1);
+    while (favorites_hash[slot]) slot = (slot + 1) & (hash_size - 1);
+    favorites_hash[slot] = index + 1;
+}
+
+// Rebuild the index and drop the cached orders after the list changed
+static void rebuild_index(void) {
+    if (favorites_hash) memset(favorites_hash, 0, hash_size * sizeof(int));
+    for (int i = 0; i < favorite_count; i++) {
+        index_favorite(i);
+    }
+    memset(order_valid, 0, sizeof(order_valid));
+}
+
+// Room for one more favorite, growing the table, index and orders together
+static bool reserve_favorite(void) {
+    if (favorite_count < favorite_capacity) return true;
+
+    int capacity = favorite_capacity ? favorite_capacity * 2 : 32;
+    Favorite *grown = (Favorite*)realloc(favorites, capacity * sizeof(Favorite));
+    if (!grown) return false;
+    favorites = grown;
+
+    for (int i = 0; i < FAVORITES_SORT_COUNT; i++) {
+        int *order = (int*)realloc(orders[i], capacity * sizeof(int));
+        if (!order) return false;
+        orders[i] = order;
+    }
+
+    int *hash = (int*)realloc(favorites_hash, capacity * 2 * sizeof(int));
+    if (!hash) return false;
+    favorites_hash = hash;
+    hash_size = capacity * 2;
+    favorite_capacity = capacity;
+
+    rebuild_index();
+    return true;
+}
+
+// Copy a string into the pool, returning its offset
+static bool pool_add(const char *text, uint32_t *offset) {
+    uint32_t length = strlen(text) + 1;
+    if (pool_used + length > pool_capacity) {
+        uint32_t capacity = pool_capacity ? pool_capacity : 4096;
+        while (pool_used + length > capacity) capacity *= 2;
+        char *grown = (char*)realloc(pool, capacity);
+        if (!grown) return false;
+        pool = grown;
+        pool_capacity = capacity;
+    }
+
+    memcpy(pool + pool_used, text, length);
+    *offset = pool_used;
+    pool_used += length;
+    return true;
+}
+
+// Drop the strings of removed favorites once they make up half the pool
+static void compact_pool(void) {
+    if (pool_garbage < 4096 || pool_garbage * 2 < pool_used) return;
+
+    char *compacted = (char*)malloc(pool_capacity);
+    if (!compacted) return;
+
+    uint32_t used = 0;
+    for (int i = 0; i < favorite_count; i++) {
+        uint32_t *fields[3] = { &favorites[i].core_name, &favorites[i].game_name, &favorites[i].full_path };
+        for (int f = 0; f < 3; f++) {
+            uint32_t length = strlen(pool_string(*fields[f])) + 1;
+            memcpy(compacted + used, pool_string(*fields[f]), length);
+            *fields[f] = used;
+            used += length;
+        }
+    }
+
+    free(pool);
+    pool = compacted;
+    pool_used = used;
+    pool_garbage = 0;
+}
+
+// Index of a favorite by core and game, or -1
+static int find_favorite(const char *core_name, const char *game_name) {
+    for (int i = 0; i < favorite_count; i++) {
+        if (strcmp(pool_string(favorites[i].core_name), core_name) == 0 &&
+            strcmp(pool_string(favorites[i].game_name), game_name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static bool add_favorite(const char *core_name, const char *game_name, const char *full_path) {
+    if (!reserve_favorite()) return false;
+
+    Favorite *favorite = &favorites[favorite_count];
+    uint32_t saved_used = pool_used;
+    if (!pool_add(core_name, &favorite->core_name) ||
+        !pool_add(game_name, &favorite->game_name) ||
+        !pool_add(full_path, &favorite->full_path)) {
+        pool_used = saved_used;
+        return false;
+    }
+    favorite->key = favorite_key(full_path, game_name);
+
+    index_favorite(favorite_count);
+    favorite_count++;
+    memset(order_valid, 0, sizeof(order_valid));
+    return true;
+}
+
+static void remove_favorite(int index) {
+    Favorite *favorite = &favorites[index];
+    pool_garbage += strlen(pool_string(favorite->core_name)) + strlen(pool_string(favorite->game_name)) +
+                    strlen(pool_string(favorite->full_path)) + 3;
+
+    // Shift all entries after the removed one
+    memmove(&favorites[index], &favorites[index + 1], (favorite_count - index - 1) * sizeof(Favorite));
+    favorite_count--;
+
+    compact_pool();
+    rebuild_index();
+}
+
+// Split "core_name|game_name|full_path" in place. full_path is NULL for
+// lines with only two fields.
+static bool split_record(char *line, char **core_name, char **game_name, char **full_path) {
+    char *separator1 = strchr(line, '|');
+    if (!separator1) return false;
+    *separator1 = '\0';
+
+    char *separator2 = strchr(separator1 + 1, '|');
+    if (separator2) *separator2 = '\0';
+
+    *core_name = line;
+    *game_name = separator1 + 1;
+    *full_path = separator2 ? separator2 + 1 : NULL;
+    return true;
+}
+
+// Journal records: "+core_name|game_name|full_path" adds a favorite,
+// "-core_name|game_name" removes one. Both are no-ops when already applied.
+static void apply_record(char *record) {
+    char *core_name, *game_name, *full_path;
+    if (!split_record(record + 1, &core_name, &game_name, &full_path)) return;
+
+    int index = find_favorite(core_name, game_name);
+    if (record[0] == '+' && index < 0 && full_path) {
+        add_favorite(core_name, game_name, full_path);
+    } else if (record[0] == '-' && index >= 0) {
+        remove_favorite(index);
+    }
+}
+
+// Journal record for adding ('+') or removing ('-') a favorite
+static void format_record(char *record, size_t size, char op, int index) {
+    const Favorite *favorite = &favorites[index];
+    if (op == '+') {
+        snprintf(record, size, "+%s|%s|%s", pool_string(favorite->core_name),
+                 pool_string(favorite->game_name), pool_string(favorite->full_path));
+    } else {
+        snprintf(record, size, "-%s|%s", pool_string(favorite->core_name), pool_string(favorite->game_name));
+    }
+}
+
+// Record a change already made in memory, rewriting the whole file if the
+// journal can't be written
+static void journal_change(const char *record) {
+    if (journal_append(FAVORITES_JOURNAL, record)) {
+        journal_records++;
+    } else {
+        favorites_save();
+    }
+}
 
 void favorites_init(void) {
     favorite_count = 0;
@@ -14,87 +243,75 @@ void favorites_init(void) {
 }
 
 void favorites_load(void) {
-    FILE *fp = fopen(FAVORITES_FILE, "r");
-    if (!fp) {
-        favorite_count = 0;
-        return;
-    }
-
     favorite_count = 0;
-    char line[512];
-
-    while (fgets(line, sizeof(line), fp) && favorite_count < MAX_FAVORITES) {
-        // Remove newline
-        line[strcspn(line, "\r\n")] = 0;
-
-        // Parse line: "core_name|game_name|full_path"
-        char *separator1 = strchr(line, '|');
-        if (separator1) {
-            *separator1 = '\0';
-            char *separator2 = strchr(separator1 + 1, '|');
-            if (separator2) {
-                *separator2 = '\0';
-                strncpy(favorites[favorite_count].core_name, line, sizeof(favorites[favorite_count].core_name) - 1);
-                strncpy(favorites[favorite_count].game_name, separator1 + 1, sizeof(favorites[favorite_count].game_name) - 1);
-                strncpy(favorites[favorite_count].full_path, separator2 + 1, sizeof(favorites[favorite_count].full_path) - 1);
-
-                // Create display name
-                snprintf(favorites[favorite_count].display_name, sizeof(favorites[favorite_count].display_name),
-                        "%s (%s)", favorites[favorite_count].game_name, favorites[favorite_count].core_name);
-
-                favorite_count++;
+    pool_used = 0;
+    pool_garbage = 0;
+    rebuild_index();
+
+    FILE *fp = journal_open_snapshot(FAVORITES_FILE, FAVORITES_TEMP_FILE);
+    if (fp) {
+        char line[FAVORITES_LINE_SIZE];
+        while (vfs_fgets(line, sizeof(line), fp)) {
+            // Remove newline
+            line[strcspn(line, "\r\n")] = 0;
+
+            // Parse line: "core_name|game_name|full_path"
+            char *core_name, *game_name, *full_path;
+            if (split_record(line, &core_name, &game_name, &full_path) && full_path) {
+                add_favorite(core_name, game_name, full_path);
             }
         }
+        vfs_fclose(fp);
     }
 
-    fclose(fp);
+    // Fold a long journal back into the snapshot
+    journal_records = journal_replay(FAVORITES_JOURNAL, apply_record);
+    favorites_compact();
 }
 
+void favorites_compact(void) {
+    if (journal_records >= JOURNAL_COMPACT_RECORDS) favorites_save();
+}
+
+// Write the whole list as a new snapshot, which also empties the journal
 void favorites_save(void) {
-    FILE *fp = fopen(FAVORITES_FILE, "w");
+    FILE *fp = vfs_fopen(FAVORITES_TEMP_FILE, "w");
     if (!fp) return;
 
-    for (int i = 0; i < favorite_count; i++) {
-        fprintf(fp, "%s|%s|%s\n", favorites[i].core_name, favorites[i].game_name, favorites[i].full_path);
+    int ok = 1;
+    for (int i = 0; i < favorite_count && ok; i++) {
+        ok = vfs_fprintf(fp, "%s|%s|%s\n", pool_string(favorites[i].core_name),
+                         pool_string(favorites[i].game_name), pool_string(favorites[i].full_path)) >= 0;
     }
 
-    fclose(fp);
+    if (vfs_fclose(fp) != 0) ok = 0;
+    if (ok) {
+        if (journal_commit(FAVORITES_FILE, FAVORITES_TEMP_FILE, FAVORITES_JOURNAL)) journal_records = 0;
+    } else {
+        vfs_remove(FAVORITES_TEMP_FILE);
+    }
 }
 
 bool favorites_toggle(const char *core_name, const char *game_name, const char *full_path) {
     // Check if already favorited
-    int existing_index = -1;
-    for (int i = 0; i < favorite_count; i++) {
-        if (strcmp(favorites[i].core_name, core_name) == 0 &&
-            strcmp(favorites[i].game_name, game_name) == 0) {
-            existing_index = i;
-            break;
-        }
-    }
+    int existing_index = find_favorite(core_name, game_name);
+    char record[FAVORITES_LINE_SIZE];
 
     if (existing_index >= 0) {
         // Remove from favorites
-        for (int i = existing_index; i < favorite_count - 1; i++) {
-            favorites[i] = favorites[i + 1];
-        }
-        favorite_count--;
-        favorites_save();
+        format_record(record, sizeof(record), '-', existing_index);
+        remove_favorite(existing_index);
+        journal_change(record);
         return false; // Removed
-    } else {
-        // Add to favorites
-        if (favorite_count >= MAX_FAVORITES) {
-            return false; // List full
-        }
+    }
 
-        strncpy(favorites[favorite_count].core_name, core_name, sizeof(favorites[favorite_count].core_name) - 1);
-        strncpy(favorites[favorite_count].game_name, game_name, sizeof(favorites[favorite_count].game_name) - 1);
-        strncpy(favorites[favorite_count].full_path, full_path, sizeof(favorites[favorite_count].full_path) - 1);
-        snprintf(favorites[favorite_count].display_name, sizeof(favorites[favorite_count].display_name),
-                "%s (%s)", game_name, core_name);
-        favorite_count++;
-        favorites_save();
-        return true; // Added
+    // Add to favorites
+    if (!add_favorite(core_name, game_name, full_path)) {
+        return false; // Out of memory
     }
+    format_record(record, sizeof(record), '+', favorite_count - 1);
+    journal_change(record);
+    return true; // Added
 }
 
 bool favorites_remove_by_index(int index) {
@@ -102,29 +319,77 @@ bool favorites_remove_by_index(int index) {
         return false;
     }
 
-    // Shift all entries after the removed one
-    for (int i = index; i < favorite_count - 1; i++) {
-        favorites[i] = favorites[i + 1];
-    }
-    favorite_count--;
-    favorites_save();
+    char record[FAVORITES_LINE_SIZE];
+    format_record(record, sizeof(record), '-', index);
+    remove_favorite(index);
+    journal_change(record);
     return true;
 }
 
 bool favorites_is_favorited(const char *directory, const char *game_name) {
-    for (int i = 0; i < favorite_count; i++) {
-        if (strcmp(favorites[i].full_path, directory) == 0 &&
-            strcmp(favorites[i].game_name, game_name) == 0) {
+    if (favorite_count == 0) return false;
+
+    uint32_t key = favorite_key(directory, game_name);
+    int slot = key & (hash_size - 1);
+
+    while (favorites_hash[slot]) {
+        int i = favorites_hash[slot] - 1;
+        if (favorites[i].key == key &&
+            strcmp(pool_string(favorites[i].full_path), directory) == 0 &&
+            strcmp(pool_string(favorites[i].game_name), game_name) == 0) {
             return true;
         }
+        slot = (slot + 1) & (hash_size - 1);
     }
     return false;
 }
 
-const FavoriteGame* favorites_get_list(void) {
-    return favorites;
-}
-
 int favorites_get_count(void) {
     return favorite_count;
 }
+
+const char *favorites_get_core_name(int index) {
+    return pool_string(favorites[index].core_name);
+}
+
+const char *favorites_get_game_name(int index) {
+    return pool_string(favorites[index].game_name);
+}
+
+const char *favorites_get_full_path(int index) {
+    return pool_string(favorites[index].full_path);
+}
+
+static int compare_by_name(const void *a, const void *b) {
+    const Favorite *favorite_a = &favorites[*(const int*)a];
+    const Favorite *favorite_b = &favorites[*(const int*)b];
+    int result = strcasecmp(pool_string(favorite_a->game_name), pool_string(favorite_b->game_name));
+    return result ? result : *(const int*)a - *(const int*)b;
+}
+
+static int compare_by_system(const void *a, const void *b) {
+    const Favorite *favorite_a = &favorites[*(const int*)a];
+    const Favorite *favorite_b = &favorites[*(const int*)b];
+    int result = strcasecmp(pool_string(favorite_a->core_name), pool_string(favorite_b->core_name));
+    return result ? result : compare_by_name(a, b);
+}
+
+const int *favorites_get_order(FavoritesSort sort) {
+    int *order = orders[sort];
+    if (!order_valid[sort] && favorite_count > 0) {
+        for (int i = 0; i < favorite_count; i++) {
+            order[i] = sort == FAVORITES_SORT_ADDED ? favorite_count - 1 - i : i;
+        }
+        if (sort == FAVORITES_SORT_NAME) {
+            qsort(order, favorite_count, sizeof(int), compare_by_name);
+        } else if (sort == FAVORITES_SORT_SYSTEM) {
+            qsort(order, favorite_count, sizeof(int), compare_by_system);
+        }
+        order_valid[sort] = true;
+    }
+    return order;
+}
+
+const char *favorites_sort_name(FavoritesSort sort) {
+    return sort_names[sort];
+}
@@ -3,22 +3,35 @@
 
 #include <stdbool.h>
 
-#define MAX_FAVORITES 100
-
-typedef struct {
-    char core_name[64];
-    char game_name[256];
-    char full_path[512];
-    char display_name[320];
-} FavoriteGame;
+// Orders the favorites list can be shown in
+typedef enum {
+    FAVORITES_SORT_ADDED,   // Most recently added first
+    FAVORITES_SORT_NAME,    // By game name
+    FAVORITES_SORT_SYSTEM,  // By core, then game name
+    FAVORITES_SORT_COUNT
+} FavoritesSort;
 
 void favorites_init(void);
 void favorites_load(void);
 void favorites_save(void);
+
+// Write a new snapshot if the journal has grown past JOURNAL_COMPACT_RECORDS
+// since the last one. Called between user actions.
+void favorites_compact(void);
 bool favorites_toggle(const char *core_name, const char *game_name, const char *full_path);
 bool favorites_remove_by_index(int index);
 bool favorites_is_favorited(const char *core_name, const char *game_name);
-const FavoriteGame* favorites_get_list(void);
 int favorites_get_count(void);
 
+// Fields of a favorite. Indexes are in the order favorites were added and
+// stay valid until the list changes.
+const char *favorites_get_core_name(int index);
+const char *favorites_get_game_name(int index);
+const char *favorites_get_full_path(int index);
+
+// Favorite indexes in the given order, favorites_get_count() of them. The
+// array is cached until the list changes.
+const int *favorites_get_order(FavoritesSort sort);
+const char *favorites_sort_name(FavoritesSort sort);
+
 #endif
@@ -1,7 +1,10 @@
 #define STB_TRUETYPE_IMPLEMENTATION
 #include "stb_truetype.h"
 #include "font.h"
+#include "font_baked.h"
 #include "settings.h"
+#include "profile.h"
+#include "vfs.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -13,44 +16,321 @@ static int font_loaded = 0;
 
 #define FONT_SIZE 20.0f
 
-// Internal function to load a font file
-static int load_font_file(const char *font_filename) {
-    // Free previous font if loaded
+// Glyph atlas - printable ASCII is rasterized once per font load so text
+// drawing is a plain blit instead of a TrueType rasterization per character
+#define ATLAS_FIRST_CHAR 32
+#define ATLAS_LAST_CHAR 126
+#define ATLAS_GLYPH_COUNT (ATLAS_LAST_CHAR - ATLAS_FIRST_CHAR + 1)
+
+typedef struct {
+    int glyph_index;   // stb_truetype glyph index (0 = not in font)
+    int advance;       // Scaled advance width in pixels
+    int xoff;          // Bitmap offset from pen position
+    int yoff;          // Bitmap offset from baseline
+    int width;
+    int height;
+    int offset;        // Start of the bitmap in glyph_atlas
+} AtlasGlyph;
+
+static AtlasGlyph atlas_glyphs[ATLAS_GLYPH_COUNT];
+static signed char atlas_kerning[ATLAS_GLYPH_COUNT][ATLAS_GLYPH_COUNT];
+static unsigned char *glyph_atlas = NULL;
+static unsigned char *atlas_block = NULL; // Allocation backing glyph_atlas
+static int font_baseline = 0;
+
+// Anti-aliasing blend tables, one per text colour. Each table maps a 4-bit
+// coverage level and one destination channel to the blended channel value
+// already shifted into place, so a blend against whatever is under the text
+// (background, pillbox, thumbnail) is three lookups and two ORs.
+#define BLEND_SLOTS 8
+
+typedef struct {
+    uint16_t fg;
+    int valid;
+    uint16_t r[16][32];
+    uint16_t g[16][64];
+    uint16_t b[16][32];
+} BlendTable;
+
+static BlendTable blend_tables[BLEND_SLOTS];
+static int blend_next_slot = 0;
+
+// Name of the font currently loaded, to skip redundant reloads
+static char loaded_font_name[64] = "";
+
+// TrueType file and pixel size of the current font. A baked font only covers
+// the atlas, so the outlines are loaded on demand for anything beyond it.
+static char loaded_font_file[64] = "";
+static float font_pixel_size = FONT_SIZE;
+static int outline_fonts_tried = 0;
+
+// Optional second font for scripts the UI fonts lack (CJK, Cyrillic, ...)
+#define FALLBACK_FONT_FILE "fallback.ttf"
+
+static stbtt_fontinfo fallback_info;
+static unsigned char *fallback_buffer = NULL;
+static float fallback_scale;
+
+// Glyph cache for characters outside the atlas. Rasterizing an outline is far
+// too slow to repeat every frame, so each glyph is rasterized once into a
+// fixed-size cell and kept until it is the least recently used one. Misses
+// are cached too, so a missing glyph costs one lookup rather than a search
+// through every font.
+#define GLYPH_CACHE_SIZE 128
+#define GLYPH_CACHE_BUCKETS 64
+#define GLYPH_CELL_WIDTH 32
+#define GLYPH_CELL_HEIGHT 32
+#define GLYPH_CELL_BYTES (BAKED_FONT_ROW_BYTES(GLYPH_CELL_WIDTH) * GLYPH_CELL_HEIGHT)
+
+typedef struct {
+    uint32_t codepoint;
+    int found;         // 0 = no font has this glyph
+    int advance;
+    int xoff;
+    int yoff;
+    int width;
+    int height;
+    int16_t lru_prev;  // Towards most recently used
+    int16_t lru_next;  // Towards least recently used
+    int16_t hash_next; // Next entry in the same bucket
+} CachedGlyph;
+
+static CachedGlyph glyph_cache[GLYPH_CACHE_SIZE];
+static unsigned char glyph_cache_bitmaps[GLYPH_CACHE_SIZE][GLYPH_CELL_BYTES];
+static int16_t glyph_cache_buckets[GLYPH_CACHE_BUCKETS];
+static int16_t glyph_cache_lru_head = -1;
+static int16_t glyph_cache_lru_tail = -1;
+static int glyph_cache_used = 0;
+
+// Memoized widths for font_measure_text(). The UI measures the same legend,
+// header and counter strings every frame; a hit is one hash and one compare.
+// Strings too long for an entry are measured directly.
+#define MEASURE_CACHE_SIZE 64
+#define MEASURE_TEXT_MAX 48
+
+typedef struct {
+    uint32_t hash;
+    int width;
+    char text[MEASURE_TEXT_MAX];
+} MeasuredText;
+
+static MeasuredText measure_cache[MEASURE_CACHE_SIZE];
+
+// Bumped on every font load so callers can drop anything rendered with the old font
+static int font_generation = 0;
+
+static inline int atlas_has_char(int c) {
+    return c >= ATLAS_FIRST_CHAR && c <= ATLAS_LAST_CHAR;
+}
+
+// Rasterize the printable glyph set into a packed 4-bit coverage atlas and cache
+// advance, bearing, baseline and kerning for the current scale
+static int build_glyph_atlas(void) {
+    int ascent, descent, line_gap;
+    stbtt_GetFontVMetrics(&font_info, &ascent, &descent, &line_gap);
+    font_baseline = (int)(ascent * font_scale);
+
+    // First pass: metrics and bitmap sizes
+    int atlas_size = 0;
+    for (int i = 0; i < ATLAS_GLYPH_COUNT; i++) {
+        AtlasGlyph *g = &atlas_glyphs[i];
+        memset(g, 0, sizeof(*g));
+        g->glyph_index = stbtt_FindGlyphIndex(&font_info, ATLAS_FIRST_CHAR + i);
+        if (g->glyph_index == 0) continue;
+
+        int advance_width, left_side_bearing;
+        stbtt_GetGlyphHMetrics(&font_info, g->glyph_index, &advance_width, &left_side_bearing);
+        g->advance = (int)(advance_width * font_scale);
+
+        int x0, y0, x1, y1;
+        stbtt_GetGlyphBitmapBox(&font_info, g->glyph_index, font_scale, font_scale, &x0, &y0, &x1, &y1);
+        g->xoff = x0;
+        g->yoff = y0;
+        g->width = x1 - x0;
+        g->height = y1 - y0;
+        g->offset = atlas_size;
+        atlas_size += BAKED_FONT_ROW_BYTES(g->width) * g->height;
+    }
+
+    atlas_block = (unsigned char*)malloc(atlas_size > 0 ? atlas_size : 1);
+    if (!atlas_block) return 0;
+    glyph_atlas = atlas_block;
+
+    // Second pass: rasterize every glyph and pack it as 4-bit coverage
+    for (int i = 0; i < ATLAS_GLYPH_COUNT; i++) {
+        AtlasGlyph *g = &atlas_glyphs[i];
+        if (g->width > 0 && g->height > 0) {
+            int w, h, xoff, yoff;
+            unsigned char *bitmap = stbtt_GetGlyphBitmap(&font_info, font_scale, font_scale,
+                                                         g->glyph_index, &w, &h, &xoff, &yoff);
+            if (!bitmap) continue;
+            baked_font_pack_coverage(bitmap, g->width, g->height, glyph_atlas + g->offset);
+            stbtt_FreeBitmap(bitmap, NULL);
+        }
+    }
+
+    // Kerning between every pair of atlas glyphs
+    for (int a = 0; a < ATLAS_GLYPH_COUNT; a++) {
+        for (int b = 0; b < ATLAS_GLYPH_COUNT; b++) {
+            int kern = 0;
+            if (atlas_glyphs[a].glyph_index && atlas_glyphs[b].glyph_index) {
+                kern = (int)(stbtt_GetGlyphKernAdvance(&font_info, atlas_glyphs[a].glyph_index,
+                                                       atlas_glyphs[b].glyph_index) * font_scale);
+            }
+            atlas_kerning[a][b] = (signed char)kern;
+        }
+    }
+
+    return 1;
+}
+
+static void glyph_cache_clear(void) {
+    for (int i = 0; i < GLYPH_CACHE_BUCKETS; i++) {
+        glyph_cache_buckets[i] = -1;
+    }
+    glyph_cache_lru_head = -1;
+    glyph_cache_lru_tail = -1;
+    glyph_cache_used = 0;
+}
+
+// Release the current font, its TrueType data and its atlas
+static void free_font(void) {
     if (font_buffer) {
         free(font_buffer);
         font_buffer = NULL;
-        font_loaded = 0;
     }
+    if (atlas_block) {
+        free(atlas_block);
+        atlas_block = NULL;
+    }
+    glyph_atlas = NULL;
+    font_loaded = 0;
+    loaded_font_name[0] = '\0';
+    outline_fonts_tried = 0;
+    glyph_cache_clear();
+    memset(measure_cache, 0, sizeof(measure_cache));
+}
 
+// Open a font resource from the SD card, falling back to the working directory
+static FILE *open_font_resource(const char *filename) {
     // Build search paths for the font
     char font_paths[2][256];
-    snprintf(font_paths[0], sizeof(font_paths[0]), "/mnt/sda1/frogui/fonts/%s", font_filename);
-    snprintf(font_paths[1], sizeof(font_paths[1]), "fonts/%s", font_filename);
+    snprintf(font_paths[0], sizeof(font_paths[0]), "/mnt/sda1/frogui/fonts/%s", filename);
+    snprintf(font_paths[1], sizeof(font_paths[1]), "fonts/%s", filename);
 
     FILE *fp = NULL;
     for (int i = 0; i < 2; i++) {
-        fp = fopen(font_paths[i], "rb");
+        fp = vfs_fopen(font_paths[i], "rb");
         if (fp) break;
     }
+    return fp;
+}
+
+static int read_le16s(const unsigned char *p) {
+    return (int16_t)(p[0] | (p[1] << 8));
+}
+
+static unsigned int read_le32u(const unsigned char *p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+// Load a pre-baked .bfont generated by scripts/bake_font.c. The file is read
+// with a single fread and its bitmap block is used in place as the atlas.
+static int load_baked_font(const char *font_filename, float pixel_size) {
+    // GamePocket-Regular-ZeroKern.ttf -> GamePocket-Regular-ZeroKern.bfont
+    char baked_filename[128];
+    const char *ext = strrchr(font_filename, '.');
+    int base_len = ext ? (int)(ext - font_filename) : (int)strlen(font_filename);
+    snprintf(baked_filename, sizeof(baked_filename), "%.*s%s", base_len, font_filename, BAKED_FONT_EXTENSION);
+
+    FILE *fp = open_font_resource(baked_filename);
+    if (!fp) {
+        return 0;
+    }
+
+    vfs_fseek(fp, 0, SEEK_END);
+    long file_size = vfs_ftell(fp);
+    vfs_fseek(fp, 0, SEEK_SET);
+
+    long tables_size = BAKED_FONT_HEADER_SIZE + ATLAS_GLYPH_COUNT * BAKED_FONT_GLYPH_SIZE +
+                       ATLAS_GLYPH_COUNT * ATLAS_GLYPH_COUNT;
+    if (file_size < tables_size) {
+        vfs_fclose(fp);
+        return 0;
+    }
+
+    unsigned char *data = (unsigned char*)malloc(file_size);
+    if (!data) {
+        vfs_fclose(fp);
+        return 0;
+    }
+
+    size_t bytes_read = vfs_fread(data, 1, file_size, fp);
+    vfs_fclose(fp);
+
+    // Validate header against what this build expects
+    if (bytes_read != (size_t)file_size ||
+        memcmp(data, BAKED_FONT_MAGIC, 4) != 0 ||
+        read_le16s(data + 4) != BAKED_FONT_VERSION ||
+        read_le16s(data + 6) != (int)pixel_size ||
+        read_le16s(data + 10) != ATLAS_FIRST_CHAR ||
+        read_le16s(data + 12) != ATLAS_GLYPH_COUNT ||
+        tables_size + (long)read_le32u(data + 16) != file_size) {
+        free(data);
+        return 0;
+    }
+
+    unsigned int bitmap_size = read_le32u(data + 16);
+    font_baseline = read_le16s(data + 8);
+
+    const unsigned char *p = data + BAKED_FONT_HEADER_SIZE;
+    for (int i = 0; i < ATLAS_GLYPH_COUNT; i++, p += BAKED_FONT_GLYPH_SIZE) {
+        AtlasGlyph *g = &atlas_glyphs[i];
+        g->glyph_index = (uint16_t)read_le16s(p + 0);
+        g->advance = read_le16s(p + 2);
+        g->xoff = read_le16s(p + 4);
+        g->yoff = read_le16s(p + 6);
+        g->width = (uint16_t)read_le16s(p + 8);
+        g->height = (uint16_t)read_le16s(p + 10);
+        g->offset = read_le32u(p + 12);
+
+        // Reject glyphs pointing outside the bitmap block
+        if ((unsigned int)g->offset + (unsigned int)(BAKED_FONT_ROW_BYTES(g->width) * g->height) > bitmap_size) {
+            free(data);
+            return 0;
+        }
+    }
+
+    memcpy(atlas_kerning, p, sizeof(atlas_kerning));
+    p += sizeof(atlas_kerning);
+
+    atlas_block = data;
+    glyph_atlas = (unsigned char*)p;
+    font_loaded = 1;
+    return 1;
+}
 
+// Internal function to load a font file and bake it at the given pixel size
+static int load_font_file(const char *font_filename, float pixel_size) {
+    FILE *fp = open_font_resource(font_filename);
     if (!fp) {
         return 0;
     }
 
     // Get file size
-    fseek(fp, 0, SEEK_END);
-    long font_size = ftell(fp);
-    fseek(fp, 0, SEEK_SET);
+    vfs_fseek(fp, 0, SEEK_END);
+    long font_size = vfs_ftell(fp);
+    vfs_fseek(fp, 0, SEEK_SET);
 
     // Allocate buffer and read font
     font_buffer = (unsigned char*)malloc(font_size);
     if (!font_buffer) {
-        fclose(fp);
+        vfs_fclose(fp);
         return 0;
     }
 
-    fread(font_buffer, 1, font_size, fp);
-    fclose(fp);
+    vfs_fread(font_buffer, 1, font_size, fp);
+    vfs_fclose(fp);
 
     // Initialize font
     if (!stbtt_InitFont(&font_info, font_buffer, stbtt_GetFontOffsetForIndex(font_buffer, 0))) {
@@ -60,11 +340,67 @@ static int load_font_file(const char *font_filename) {
     }
 
     // Calculate scale for desired pixel height
-    font_scale = stbtt_ScaleForPixelHeight(&font_info, FONT_SIZE);
+    font_scale = stbtt_ScaleForPixelHeight(&font_info, pixel_size);
+
+    if (!build_glyph_atlas()) {
+        free_font();
+        return 0;
+    }
+
     font_loaded = 1;
     return 1;
 }
 
+// Load a TrueType file into memory and initialize stb_truetype on it
+static unsigned char *load_outline_font(const char *filename, stbtt_fontinfo *info) {
+    FILE *fp = open_font_resource(filename);
+    if (!fp) {
+        return NULL;
+    }
+
+    vfs_fseek(fp, 0, SEEK_END);
+    long size = vfs_ftell(fp);
+    vfs_fseek(fp, 0, SEEK_SET);
+
+    unsigned char *buffer = (unsigned char*)malloc(size);
+    if (!buffer) {
+        vfs_fclose(fp);
+        return NULL;
+    }
+
+    size_t bytes_read = vfs_fread(buffer, 1, size, fp);
+    vfs_fclose(fp);
+
+    if (bytes_read != (size_t)size ||
+        !stbtt_InitFont(info, buffer, stbtt_GetFontOffsetForIndex(buffer, 0))) {
+        free(buffer);
+        return NULL;
+    }
+    return buffer;
+}
+
+// Make the outline fonts available for glyphs outside the atlas: the UI
+// font's own .ttf when a baked font is active, then the fallback font.
+// Only attempted once per font load so a missing file is not retried.
+static void load_outline_fonts(void) {
+    if (outline_fonts_tried) return;
+    outline_fonts_tried = 1;
+
+    if (!font_buffer) {
+        font_buffer = load_outline_font(loaded_font_file, &font_info);
+        if (font_buffer) {
+            font_scale = stbtt_ScaleForPixelHeight(&font_info, font_pixel_size);
+        }
+    }
+
+    if (!fallback_buffer) {
+        fallback_buffer = load_outline_font(FALLBACK_FONT_FILE, &fallback_info);
+    }
+    if (fallback_buffer) {
+        fallback_scale = stbtt_ScaleForPixelHeight(&fallback_info, font_pixel_size);
+    }
+}
+
 void font_load_from_settings(const char *font_name) {
     const char *font_filename = NULL;
     float custom_size = FONT_SIZE;
@@ -82,164 +418,408 @@ void font_load_from_settings(const char *font_name) {
         custom_size = 18.0f; // GamePocket at 18px
     }
 
-    load_font_file(font_filename);
+    // Already loaded (font_init() and apply_settings() both ask at boot)
+    if (font_loaded && strcmp(loaded_font_name, font_name) == 0) {
+        return;
+    }
+
+    free_font();
 
-    // Recalculate scale if custom size is different
-    if (custom_size != FONT_SIZE && font_loaded) {
-        font_scale = stbtt_ScaleForPixelHeight(&font_info, custom_size);
+    strncpy(loaded_font_file, font_filename, sizeof(loaded_font_file) - 1);
+    loaded_font_file[sizeof(loaded_font_file) - 1] = '\0';
+    font_pixel_size = custom_size;
+
+    // Prefer the pre-baked bitmap font, TrueType is only a fallback
+    if (load_baked_font(font_filename, custom_size) || load_font_file(font_filename, custom_size)) {
+        strncpy(loaded_font_name, font_name, sizeof(loaded_font_name) - 1);
+        loaded_font_name[sizeof(loaded_font_name) - 1] = '\0';
     }
+    font_generation++;
+}
+
+int font_get_generation(void) {
+    return font_generation;
 }
 
 void font_init(void) {
-    // Load default font initially
-    font_load_from_settings("GamePocket");
+    // Load the configured font if settings are already loaded, else the default
+    const char *font_name = settings_get_value("frogui_font");
+    font_load_from_settings(font_name ? font_name : "GamePocket");
 }
 
-void font_draw_char(uint16_t *framebuffer, int screen_width, int screen_height,
-                   int x, int y, char c, uint16_t color) {
-    if (!font_loaded || !framebuffer) return;
+// Fill the blend table for one text colour:
+// out = (fg * a + dst * (15 - a)) / 15 per channel, for every coverage a
+static void build_blend_table(BlendTable *t, uint16_t fg) {
+    int fr = (fg >> 11) & 0x1F;
+    int fgc = (fg >> 5) & 0x3F;
+    int fb = fg & 0x1F;
+
+    for (int a = 0; a < 16; a++) {
+        for (int d = 0; d < 32; d++) {
+            t->r[a][d] = (uint16_t)(((fr * a + d * (15 - a) + 7) / 15) << 11);
+            t->b[a][d] = (uint16_t)((fb * a + d * (15 - a) + 7) / 15);
+        }
+        for (int d = 0; d < 64; d++) {
+            t->g[a][d] = (uint16_t)(((fgc * a + d * (15 - a) + 7) / 15) << 5);
+        }
+    }
+    t->fg = fg;
+    t->valid = 1;
+}
 
-    // Convert to uppercase
-    if (c >= 'a' && c <= 'z') {
-        c = c - 'a' + 'A';
+// Find the blend table for a text colour, building it on first use
+static const BlendTable *get_blend_table(uint16_t fg) {
+    for (int i = 0; i < BLEND_SLOTS; i++) {
+        if (blend_tables[i].valid && blend_tables[i].fg == fg) {
+            return &blend_tables[i];
+        }
     }
 
-    // Get glyph index
-    int glyph_index = stbtt_FindGlyphIndex(&font_info, c);
-    if (glyph_index == 0) return; // Glyph not found
+    BlendTable *t = &blend_tables[blend_next_slot];
+    blend_next_slot = (blend_next_slot + 1) % BLEND_SLOTS;
+    build_blend_table(t, fg);
+    return t;
+}
 
-    // Get glyph bitmap
-    int width, height, xoff, yoff;
-    unsigned char *bitmap = stbtt_GetGlyphBitmap(&font_info, 0, font_scale,
-                                                  glyph_index, &width, &height, &xoff, &yoff);
+void font_prepare_color(uint16_t color) {
+    get_blend_table(color);
+}
 
-    if (!bitmap) return;
+// Blend one pixel at 4-bit coverage a (1-14) using a colour's table
+static inline uint16_t blend_pixel(const BlendTable *t, int a, uint16_t dst) {
+    return t->r[a][dst >> 11] | t->g[a][(dst >> 5) & 0x3F] | t->b[a][dst & 0x1F];
+}
 
-    // Get vertical metrics for proper baseline alignment
-    int ascent, descent, line_gap;
-    stbtt_GetFontVMetrics(&font_info, &ascent, &descent, &line_gap);
-    int baseline = (int)(ascent * font_scale);
-
-    // Draw the glyph
-    for (int row = 0; row < height; row++) {
-        for (int col = 0; col < width; col++) {
-            unsigned char alpha = bitmap[row * width + col];
-            if (alpha > 0) {
-                int px = x + xoff + col;
-                int py = y + baseline + yoff + row;
-
-                if (px >= 0 && px < screen_width && py >= 0 && py < screen_height) {
-                    // Simple alpha blending
-                    if (alpha > 127) {
-                        framebuffer[py * screen_width + px] = color;
-                    }
-                }
+// Blit a packed 4-bit coverage bitmap with its top-left corner at (gx, gy)
+static void blit_glyph(uint16_t *framebuffer, int screen_width, int screen_height,
+                       int gx, int gy, int width, int height,
+                       const unsigned char *bitmap, const BlendTable *t) {
+    // Clip the glyph rectangle once instead of testing every pixel
+    int col_start = gx < 0 ? -gx : 0;
+    int row_start = gy < 0 ? -gy : 0;
+    int col_end = width;
+    int row_end = height;
+    if (gx + col_end > screen_width) col_end = screen_width - gx;
+    if (gy + row_end > screen_height) row_end = screen_height - gy;
+
+    int row_bytes = BAKED_FONT_ROW_BYTES(width);
+    for (int row = row_start; row < row_end; row++) {
+        const unsigned char *src = bitmap + row * row_bytes;
+        uint16_t *dst = framebuffer + (gy + row) * screen_width + gx;
+        for (int col = col_start; col < col_end; col++) {
+            int a = (col & 1) ? (src[col >> 1] & 0x0F) : (src[col >> 1] >> 4);
+            if (a == 0) continue;
+            dst[col] = a == 15 ? t->fg : blend_pixel(t, a, dst[col]);
+        }
+    }
+}
+
+// Decode one UTF-8 sequence and advance *text past it. Malformed bytes
+// decode as U+FFFD one byte at a time so a truncated name still renders.
+static uint32_t utf8_next(const char **text) {
+    const unsigned char *s = (const unsigned char*)*text;
+    uint32_t cp;
+    int extra;
+
+    if (s[0] < 0x80) {
+        *text += 1;
+        return s[0];
+    } else if ((s[0] & 0xE0) == 0xC0) {
+        cp = s[0] & 0x1F;
+        extra = 1;
+    } else if ((s[0] & 0xF0) == 0xE0) {
+        cp = s[0] & 0x0F;
+        extra = 2;
+    } else if ((s[0] & 0xF8) == 0xF0) {
+        cp = s[0] & 0x07;
+        extra = 3;
+    } else {
+        *text += 1;
+        return 0xFFFD;
+    }
+
+    for (int i = 1; i <= extra; i++) {
+        if ((s[i] & 0xC0) != 0x80) {
+            *text += 1;
+            return 0xFFFD;
+        }
+        cp = (cp << 6) | (s[i] & 0x3F);
+    }
+
+    *text += extra + 1;
+    return cp;
+}
+
+int font_utf8_length(const char *text) {
+    int count = 0;
+    while (text && *text) {
+        utf8_next(&text);
+        count++;
+    }
+    return count;
+}
+
+const char *font_utf8_skip(const char *text, int count) {
+    while (count-- > 0 && *text) {
+        utf8_next(&text);
+    }
+    return text;
+}
+
+// The UI draws everything in capitals: ASCII and Latin-1 letters
+static uint32_t to_upper(uint32_t cp) {
+    if (cp >= 'a' && cp <= 'z') return cp - 'a' + 'A';
+    if (cp >= 0xE0 && cp <= 0xFE && cp != 0xF7) return cp - 0x20;
+    if (cp == 0xFF) return 0x178;
+    return cp;
+}
+
+static void lru_unlink(int i) {
+    CachedGlyph *e = &glyph_cache[i];
+    if (e->lru_prev >= 0) glyph_cache[e->lru_prev].lru_next = e->lru_next;
+    else glyph_cache_lru_head = e->lru_next;
+    if (e->lru_next >= 0) glyph_cache[e->lru_next].lru_prev = e->lru_prev;
+    else glyph_cache_lru_tail = e->lru_prev;
+}
+
+static void lru_push_front(int i) {
+    CachedGlyph *e = &glyph_cache[i];
+    e->lru_prev = -1;
+    e->lru_next = glyph_cache_lru_head;
+    if (glyph_cache_lru_head >= 0) glyph_cache[glyph_cache_lru_head].lru_prev = i;
+    glyph_cache_lru_head = i;
+    if (glyph_cache_lru_tail < 0) glyph_cache_lru_tail = i;
+}
+
+// Rasterize a codepoint from the first outline font that has it
+static void rasterize_glyph(CachedGlyph *e, unsigned char *cell) {
+    load_outline_fonts();
+
+    stbtt_fontinfo *fonts[2] = { &font_info, &fallback_info };
+    float scales[2] = { font_scale, fallback_scale };
+    int available[2] = { font_buffer != NULL, fallback_buffer != NULL };
+
+    e->found = 0;
+
+    for (int f = 0; f < 2; f++) {
+        if (!available[f]) continue;
+        int glyph_index = stbtt_FindGlyphIndex(fonts[f], e->codepoint);
+        if (glyph_index == 0) continue;
+
+        int advance_width, left_side_bearing;
+        stbtt_GetGlyphHMetrics(fonts[f], glyph_index, &advance_width, &left_side_bearing);
+        e->advance = (int)(advance_width * scales[f]);
+
+        int width, height, xoff, yoff;
+        unsigned char *bitmap = stbtt_GetGlyphBitmap(fonts[f], scales[f], scales[f], glyph_index,
+                                                     &width, &height, &xoff, &yoff);
+        e->xoff = xoff;
+        e->yoff = yoff;
+        e->width = 0;
+        e->height = 0;
+        if (bitmap) {
+            // Oversized glyphs are cropped to the cell
+            int cell_w = width < GLYPH_CELL_WIDTH ? width : GLYPH_CELL_WIDTH;
+            int cell_h = height < GLYPH_CELL_HEIGHT ? height : GLYPH_CELL_HEIGHT;
+            unsigned char rows[GLYPH_CELL_WIDTH * GLYPH_CELL_HEIGHT];
+            for (int row = 0; row < cell_h; row++) {
+                memcpy(rows + row * cell_w, bitmap + row * width, cell_w);
             }
+            baked_font_pack_coverage(rows, cell_w, cell_h, cell);
+            e->width = cell_w;
+            e->height = cell_h;
+            stbtt_FreeBitmap(bitmap, NULL);
         }
+        e->found = 1;
+        return;
     }
+}
+
+// Look up a codepoint outside the atlas, rasterizing it on a miss
+static const CachedGlyph *get_cached_glyph(uint32_t cp, const unsigned char **bitmap) {
+    int bucket = cp % GLYPH_CACHE_BUCKETS;
 
-    stbtt_FreeBitmap(bitmap, NULL);
+    for (int i = glyph_cache_buckets[bucket]; i >= 0; i = glyph_cache[i].hash_next) {
+        if (glyph_cache[i].codepoint == cp) {
+            if (glyph_cache_lru_head != i) {
+                lru_unlink(i);
+                lru_push_front(i);
+            }
+            *bitmap = glyph_cache_bitmaps[i];
+            return &glyph_cache[i];
+        }
+    }
+
+    // Take a free entry, or evict the least recently used one
+    int slot;
+    if (glyph_cache_used < GLYPH_CACHE_SIZE) {
+        slot = glyph_cache_used++;
+    } else {
+        slot = glyph_cache_lru_tail;
+        lru_unlink(slot);
+
+        int16_t *link = &glyph_cache_buckets[glyph_cache[slot].codepoint % GLYPH_CACHE_BUCKETS];
+        while (*link != slot) {
+            link = &glyph_cache[*link].hash_next;
+        }
+        *link = glyph_cache[slot].hash_next;
+    }
+
+    CachedGlyph *e = &glyph_cache[slot];
+    e->codepoint = cp;
+    rasterize_glyph(e, glyph_cache_bitmaps[slot]);
+
+    e->hash_next = glyph_cache_buckets[bucket];
+    glyph_cache_buckets[bucket] = slot;
+    lru_push_front(slot);
+
+    *bitmap = glyph_cache_bitmaps[slot];
+    return e;
+}
+
+// Advance and kerning for one (uppercased) codepoint. prev is the previous
+// codepoint, 0 at the start of a line. Returns 0 if no font has the glyph.
+// Kerning only applies between atlas glyphs; the UI fonts are monospaced
+// or zero-kern, and mixed-font pairs have no meaningful kerning.
+static int get_char_metrics(uint32_t cp, uint32_t prev, int *kern, int *advance) {
+    *kern = 0;
+
+    if (atlas_has_char(cp)) {
+        const AtlasGlyph *g = &atlas_glyphs[cp - ATLAS_FIRST_CHAR];
+        if (g->glyph_index == 0) return 0;
+        if (atlas_has_char(prev) && atlas_glyphs[prev - ATLAS_FIRST_CHAR].glyph_index != 0) {
+            *kern = atlas_kerning[prev - ATLAS_FIRST_CHAR][cp - ATLAS_FIRST_CHAR];
+        }
+        *advance = g->advance;
+        return 1;
+    }
+
+    const unsigned char *bitmap;
+    const CachedGlyph *e = get_cached_glyph(cp, &bitmap);
+    if (!e->found) return 0;
+    *advance = e->advance;
+    return 1;
+}
+
+// Draw one uppercased codepoint with the pen at (x, y)
+static void draw_codepoint(uint16_t *framebuffer, int screen_width, int screen_height,
+                           int x, int y, uint32_t cp, const BlendTable *t) {
+    // Printable ASCII comes straight from the atlas
+    if (atlas_has_char(cp)) {
+        const AtlasGlyph *g = &atlas_glyphs[cp - ATLAS_FIRST_CHAR];
+        if (g->glyph_index != 0) {
+            blit_glyph(framebuffer, screen_width, screen_height, x + g->xoff, y + font_baseline + g->yoff,
+                       g->width, g->height, glyph_atlas + g->offset, t);
+        }
+        return;
+    }
+
+    const unsigned char *bitmap;
+    const CachedGlyph *e = get_cached_glyph(cp, &bitmap);
+    if (e->found) {
+        blit_glyph(framebuffer, screen_width, screen_height, x + e->xoff, y + font_baseline + e->yoff,
+                   e->width, e->height, bitmap, t);
+    }
+}
+
+void font_draw_char(uint16_t *framebuffer, int screen_width, int screen_height,
+                   int x, int y, char c, uint16_t color) {
+    if (!font_loaded || !framebuffer) return;
+
+    draw_codepoint(framebuffer, screen_width, screen_height, x, y,
+                   to_upper((unsigned char)c), get_blend_table(color));
 }
 
 void font_draw_text(uint16_t *framebuffer, int screen_width, int screen_height,
                    int x, int y, const char *text, uint16_t color) {
     if (!font_loaded || !framebuffer || !text) return;
 
+    uint32_t profile_start = profile_begin();
+    const BlendTable *t = get_blend_table(color);
     int start_x = x;
-    int prev_codepoint = 0;
+    uint32_t prev = 0;
 
     while (*text) {
         if (*text == '\n') {
             y += FONT_SIZE + 4;  // Line spacing
             x = start_x;
             text++;
-            prev_codepoint = 0;
+            prev = 0;
             continue;
         }
 
-        char c = *text;
-
-        // Convert to uppercase
-        if (c >= 'a' && c <= 'z') {
-            c = c - 'a' + 'A';
-        }
-
-        // Get glyph index
-        int glyph_index = stbtt_FindGlyphIndex(&font_info, c);
-
-        if (glyph_index != 0) {
-            // Get advance width and left side bearing
-            int advance_width, left_side_bearing;
-            stbtt_GetGlyphHMetrics(&font_info, glyph_index, &advance_width, &left_side_bearing);
+        uint32_t cp = to_upper(utf8_next(&text));
 
+        int kern, advance;
+        if (get_char_metrics(cp, prev, &kern, &advance)) {
             // Apply kerning if we have a previous character
-            if (prev_codepoint != 0) {
-                int kern = stbtt_GetGlyphKernAdvance(&font_info, prev_codepoint, glyph_index);
-                x += (int)(kern * font_scale);
-            }
+            x += kern;
 
             // Draw the character
-            font_draw_char(framebuffer, screen_width, screen_height, x, y, c, color);
+            draw_codepoint(framebuffer, screen_width, screen_height, x, y, cp, t);
 
             // Advance cursor
-            x += (int)(advance_width * font_scale);
-            prev_codepoint = glyph_index;
+            x += advance;
+            prev = cp;
         } else {
             // Space or unknown character
             x += FONT_CHAR_SPACING;
-            prev_codepoint = 0;
+            prev = 0;
         }
-
-        text++;
     }
-}
 
-int font_measure_text(const char *text) {
-    if (!text || !font_loaded) return 0;
+    profile_end(PROFILE_TEXT, profile_start);
+}
 
+static int measure_text_uncached(const char *text) {
     int width = 0;
-    int prev_codepoint = 0;
+    uint32_t prev = 0;
 
     while (*text) {
         // Skip newlines
         if (*text == '\n') {
             text++;
-            prev_codepoint = 0;
+            prev = 0;
             continue;
         }
 
-        char c = *text;
-
-        // Convert to uppercase
-        if (c >= 'a' && c <= 'z') {
-            c = c - 'a' + 'A';
-        }
-
-        // Get glyph index
-        int glyph_index = stbtt_FindGlyphIndex(&font_info, c);
-
-        if (glyph_index != 0) {
-            // Get advance width
-            int advance_width, left_side_bearing;
-            stbtt_GetGlyphHMetrics(&font_info, glyph_index, &advance_width, &left_side_bearing);
-
-            // Apply kerning if we have a previous character
-            if (prev_codepoint != 0) {
-                int kern = stbtt_GetGlyphKernAdvance(&font_info, prev_codepoint, glyph_index);
-                width += (int)(kern * font_scale);
-            }
+        uint32_t cp = to_upper(utf8_next(&text));
 
-            // Add character width
-            width += (int)(advance_width * font_scale);
-            prev_codepoint = glyph_index;
+        int kern, advance;
+        if (get_char_metrics(cp, prev, &kern, &advance)) {
+            // Kerning plus character width
+            width += kern + advance;
+            prev = cp;
         } else {
             // Space or unknown character
             width += FONT_CHAR_SPACING;
-            prev_codepoint = 0;
+            prev = 0;
         }
-
-        text++;
     }
 
     return width;
 }
+
+int font_measure_text(const char *text) {
+    if (!text || !font_loaded || !*text) return 0;
+
+    // FNV-1a over the string, which also gives its length
+    uint32_t hash = 2166136261u;
+    size_t len = 0;
+    for (const char *p = text; *p; p++, len++) {
+        hash = (hash ^ (unsigned char)*p) * 16777619u;
+    }
+    if (len >= MEASURE_TEXT_MAX) {
+        return measure_text_uncached(text);
+    }
+
+    MeasuredText *m = &measure_cache[hash % MEASURE_CACHE_SIZE];
+    if (m->hash == hash && m->text[0] && strcmp(m->text, text) == 0) {
+        return m->width;
+    }
+
+    m->hash = hash;
+    m->width = measure_text_uncached(text);
+    memcpy(m->text, text, len + 1);
+    return m->width;
+}
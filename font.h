@@ -13,13 +13,27 @@ void font_load_from_settings(const char *font_name);
 void font_draw_char(uint16_t *framebuffer, int screen_width, int screen_height, 
                    int x, int y, char c, uint16_t color);
 
-// Draw a text string at position (x, y) with given color
+// Draw a UTF-8 text string at position (x, y) with given color
 void font_draw_text(uint16_t *framebuffer, int screen_width, int screen_height,
                    int x, int y, const char *text, uint16_t color);
 
-// Measure text width in pixels
+// Precompute the anti-aliasing blend table for a text color (optional -
+// tables are also built on first use, this just moves the cost off a frame)
+void font_prepare_color(uint16_t color);
+
+// Number of UTF-8 characters (codepoints) in text
+int font_utf8_length(const char *text);
+
+// Pointer to the character count codepoints into text (or its terminator)
+const char *font_utf8_skip(const char *text, int count);
+
+// Measure text width in pixels (memoized per font)
 int font_measure_text(const char *text);
 
+// Changes whenever a different font is loaded; lets callers invalidate
+// anything pre-rendered with the previous font
+int font_get_generation(void);
+
 // Get font character width/height
 #define FONT_CHAR_WIDTH 18
 #define FONT_CHAR_HEIGHT 16
@@ -0,0 +1,59 @@
+#ifndef FONT_BAKED_H
+#define FONT_BAKED_H
+
+// Pre-baked bitmap font format (.bfont), generated on the host by
+// scripts/bake_font.c from the TrueType files in fonts/.
+//
+// All values are little-endian:
+//
+//   Header (BAKED_FONT_HEADER_SIZE bytes)
+//     0  char[4]  magic "FUIF"
+//     4  u16      version
+//     6  u16      pixel size the glyphs were rasterized at
+//     8  s16      baseline (scaled ascent) in pixels
+//    10  u16      first character code
+//    12  u16      glyph count
+//    14  u16      reserved
+//    16  u32      size of the bitmap block in bytes
+//    20  u32      reserved
+//
+//   Glyph table (glyph count * BAKED_FONT_GLYPH_SIZE bytes)
+//     0  u16      glyph index in the source font (0 = no glyph)
+//     2  s16      advance in pixels
+//     4  s16      bitmap x offset from the pen position
+//     6  s16      bitmap y offset from the baseline
+//     8  u16      bitmap width
+//    10  u16      bitmap height
+//    12  u32      bitmap offset inside the bitmap block
+//
+//   Kerning table (glyph count * glyph count bytes)
+//     s8 kerning in pixels, indexed [previous][current]
+//
+//   Bitmap block
+//     4-bit coverage (0-15), two pixels per byte with the left pixel in the
+//     high nibble. Each row starts on a byte boundary, so a glyph takes
+//     BAKED_FONT_ROW_BYTES(width) * height bytes.
+
+#define BAKED_FONT_MAGIC "FUIF"
+#define BAKED_FONT_VERSION 2
+#define BAKED_FONT_HEADER_SIZE 24
+#define BAKED_FONT_GLYPH_SIZE 16
+#define BAKED_FONT_EXTENSION ".bfont"
+
+#define BAKED_FONT_ROW_BYTES(width) (((width) + 1) / 2)
+
+// Quantize 8-bit stb_truetype coverage to 4 bits and pack two pixels per
+// byte. Shared by the host baker and the runtime TTF fallback.
+static inline void baked_font_pack_coverage(const unsigned char *src, int width, int height,
+                                            unsigned char *dst) {
+    int row_bytes = BAKED_FONT_ROW_BYTES(width);
+    for (int row = 0; row < height; row++) {
+        for (int col = 0; col < row_bytes * 2; col += 2) {
+            int hi = (src[row * width + col] * 15 + 127) / 255;
+            int lo = col + 1 < width ? (src[row * width + col + 1] * 15 + 127) / 255 : 0;
+            dst[row * row_bytes + col / 2] = (unsigned char)((hi << 4) | lo);
+        }
+    }
+}
+
+#endif // FONT_BAKED_H
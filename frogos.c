@@ -20,19 +20,27 @@ typedef void (*loader_func_t)(const char*, int);
 #define LOADER_ADDR 0x80001500
 static loader_func_t direct_loader = (loader_func_t)LOADER_ADDR;
 
-// For SF2000, use the custom dirent implementation
-#include "../../dirent.h"
 #else
-#include <dirent.h>
+
+// Host builds have no stock firmware loader. The queued game is kept in the
+// same buffers so a frontend can inspect it, and loading is a no-op.
+static char ptr_gs_run_game_file[512];
+static char ptr_gs_run_game_name[256];
+static void direct_loader(const char *game_file, int flags) { (void)game_file; (void)flags; }
+
+#define xlog printf
 #endif
 
 #include "libretro.h"
+#include "audio.h"
 #include "font.h"
+#include "profile.h"
 #include "render.h"
 #include "theme.h"
 #include "recent_games.h"
 #include "favorites.h"
 #include "settings.h"
+#include "vfs.h"
 #include "frogos.h"
 
 // Console to core name mapping (from buildcoresworking.sh)
@@ -160,6 +168,7 @@ static int empty_dirs_loaded = 0;
 // Forward declarations
 static void rebuild_empty_dirs_cache(void);
 static void show_cache_rebuild_screen(void);
+void clean_path(char *path);
 
 // Load empty directories cache from file (or rebuild if missing)
 static void load_empty_dirs_cache(void) {
@@ -167,7 +176,7 @@ static void load_empty_dirs_cache(void) {
     empty_dirs_loaded = 1;
     empty_dirs_count = 0;
 
-    FILE *fp = fopen(EMPTY_DIRS_CACHE_FILE, "r");
+    FILE *fp = vfs_fopen(EMPTY_DIRS_CACHE_FILE, "r");
     if (!fp) {
         // Cache file doesn't exist - rebuild it
         xlog("Empty dirs cache: file not found, rebuilding...\n");
@@ -176,7 +185,7 @@ static void load_empty_dirs_cache(void) {
     }
 
     char line[64];
-    while (fgets(line, sizeof(line), fp) && empty_dirs_count < MAX_EMPTY_DIRS) {
+    while (vfs_fgets(line, sizeof(line), fp) && empty_dirs_count < MAX_EMPTY_DIRS) {
         // Remove newline
         int len = strlen(line);
         if (len > 0 && line[len-1] == '\n') line[len-1] = '\0';
@@ -186,7 +195,7 @@ static void load_empty_dirs_cache(void) {
             empty_dirs_count++;
         }
     }
-    fclose(fp);
+    vfs_fclose(fp);
     xlog("Empty dirs cache: loaded %d entries\n", empty_dirs_count);
 }
 
@@ -205,11 +214,11 @@ static void rebuild_empty_dirs_cache(void) {
     show_cache_rebuild_screen();
     empty_dirs_count = 0;
 
-    DIR *dir = opendir(ROMS_PATH);
+    DIR *dir = vfs_opendir(ROMS_PATH);
     if (!dir) return;
 
     struct dirent *ent;
-    while ((ent = readdir(dir)) != NULL && empty_dirs_count < MAX_EMPTY_DIRS) {
+    while ((ent = vfs_readdir(dir)) != NULL && empty_dirs_count < MAX_EMPTY_DIRS) {
         if (ent->d_name[0] == '.') continue;
         if (strcasecmp(ent->d_name, "frogui") == 0 ||
             strcasecmp(ent->d_name, "saves") == 0 ||
@@ -227,17 +236,17 @@ static void rebuild_empty_dirs_cache(void) {
         snprintf(full_path, sizeof(full_path), "%s/%s", ROMS_PATH, entry_name);
 
         // Check if directory is empty via opendir/readdir
-        DIR *check = opendir(full_path);
+        DIR *check = vfs_opendir(full_path);
         if (check) {
             int has_content = 0;
             struct dirent *sub;
-            while ((sub = readdir(check)) != NULL) {
+            while ((sub = vfs_readdir(check)) != NULL) {
                 if (sub->d_name[0] != '.') {
                     has_content = 1;
                     break;
                 }
             }
-            closedir(check);
+            vfs_closedir(check);
 
             if (!has_content) {
                 strncpy(empty_dirs[empty_dirs_count], entry_name, sizeof(empty_dirs[0]) - 1);
@@ -246,15 +255,15 @@ static void rebuild_empty_dirs_cache(void) {
             }
         }
     }
-    closedir(dir);
+    vfs_closedir(dir);
 
     // Save to file
-    FILE *fp = fopen(EMPTY_DIRS_CACHE_FILE, "w");
+    FILE *fp = vfs_fopen(EMPTY_DIRS_CACHE_FILE, "w");
     if (fp) {
         for (int i = 0; i < empty_dirs_count; i++) {
-            fprintf(fp, "%s\n", empty_dirs[i]);
+            vfs_fprintf(fp, "%s\n", empty_dirs[i]);
         }
-        fclose(fp);
+        vfs_fclose(fp);
     }
     xlog("Empty dirs cache: rebuilt with %d entries\n", empty_dirs_count);
 }
@@ -268,20 +277,37 @@ static int thumbnail_cache_valid = 0;
 static int last_selected_index = -1;
 
 // Text scrolling state
-static int text_scroll_frame_counter = 0;
-static int text_scroll_offset = 0;
-static int text_scroll_direction = 1;
 
 // Menu state
 typedef struct {
     char path[MAX_PATH_LEN];
     char name[256];
     int is_dir;
+    int is_favorite;  // Set by scan_directory(), updated when toggled
+    int is_played;    // Set by scan_directory()
 } MenuEntry;
 
 static MenuEntry *entries = NULL;
 static int entry_count = 0;
 static int entries_capacity = 0;
+static int entries_have_favorites = 0;  // Entries come from a scanned ROM folder
+
+// The favorites and recent games views keep their entries in storage order
+// and map rows through an order cached by favorites.c or recent_games.c,
+// and a ROM folder's never played filter maps rows to its unplayed files,
+// so switching the order or filter never rebuilds entries. NULL when rows
+// are entries.
+static const int *row_order = NULL;
+static int row_order_count = 0;
+static const char *row_order_name = NULL;  // Shown after the title
+static FavoritesSort favorites_sort = FAVORITES_SORT_ADDED;
+static HistoryView history_view = HISTORY_VIEW_RECENT;
+
+// Rows of the never played filter. While it's on entry_count is the number
+// of rows and all_entry_count the number of entries.
+static int *unplayed_rows = NULL;
+static int unplayed_capacity = 0;
+static int all_entry_count = 0;
 static int selected_index = 0;
 static int scroll_offset = 0;
 static char current_path[MAX_PATH_LEN];
@@ -318,8 +344,44 @@ static void ensure_entries_capacity(int required_capacity) {
     entries_capacity = new_capacity;
 }
 
+// Play history can be long, so the recent games view only builds the
+// entries of rows that are shown: entries[0] is "..", and each game is
+// built on demand into the slot after it that its index maps to
+#define RECENT_ROW_SLOTS (VISIBLE_ENTRIES + 1)
+static int recent_rows_on_demand = 0;
+static int recent_slot_game[RECENT_ROW_SLOTS];
+
+static MenuEntry *recent_entry(int game) {
+    int slot = game % RECENT_ROW_SLOTS;
+    MenuEntry *entry = &entries[1 + slot];
+    if (recent_slot_game[slot] != game) {
+        snprintf(entry->name, sizeof(entry->name), "%s (%s)",
+                recent_games_get_game_name(game), recent_games_get_core_name(game));
+        snprintf(entry->path, sizeof(entry->path), "%s;%s",
+                recent_games_get_core_name(game), recent_games_get_game_name(game));
+        entry->is_dir = 0;
+        recent_slot_game[slot] = game;
+    }
+    return entry;
+}
+
+// Entry shown on a row of the list
+static MenuEntry *entry_at(int row) {
+    if (recent_rows_on_demand) {
+        if (row < row_order_count) return recent_entry(row_order[row]);
+        return &entries[0];
+    }
+    if (row_order && row < row_order_count) return &entries[row_order[row]];
+    return &entries[row];
+}
+
 // Reset navigation state when entering new folder
 static void reset_navigation_state(void) {
+    entries_have_favorites = 0;
+    recent_rows_on_demand = 0;
+    row_order = NULL;
+    row_order_count = 0;
+    row_order_name = NULL;
     selected_index = 0;
     scroll_offset = 0;
     boundary_delay_timer = 0;
@@ -342,6 +404,8 @@ bool resume_on_boot = false;
 bool hide_empty_folders = true;
 
 void init_direct_loader(const char* core_name, const char* directory, const char* filename) {
+    vfs_begin_action(VFS_ACTION_LAUNCH);
+
     // Don't set ptr_gs_run_folder - currently inherit from menu core for savestates to work
     // TODO: Find a way to force ptr_gs_run_folder to be /mnt/sda1/ROMS or /mnt/sda1/ARCADE (unified save states folder)
     // TODO: Replace second core_name with full directory (besides /mnt/sda1) and seperate core_name from directory
@@ -394,6 +458,14 @@ void apply_settings(void) {
         if (strcmp(var.value, "false") == 0) hide_empty_folders = false;
         else if (strcmp(var.value, "true") == 0) hide_empty_folders = true;
     }
+
+    // Frame time overlay, stage timing log and I/O log
+    var.key = "frogui_show_frametime";
+    var.value = NULL;
+    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value) {
+        profile_set_enabled(strcmp(var.value, "true") == 0);
+        vfs_set_logging(strcmp(var.value, "true") == 0);
+    }
 }
 
 // Show a loading screen during cache rebuild
@@ -447,25 +519,38 @@ static void get_corename(const char *path, char *core_name, size_t size) {
 
 // Auto-launch most recent game if resume on boot is enabled
 static void auto_launch_recent_game(void) {
-    // Get the most recent game
-    const RecentGame *recent_list = recent_games_get_list();
-    int recent_count = recent_games_get_count();
-
-    if (recent_count == 0) {
+    if (recent_games_get_count() == 0) {
         return; // No recent games to launch
     }
 
-    // Get the first (most recent) game
-    const RecentGame *game = &recent_list[0];
+    // Get the most recent game. Copied, since launching updates the history.
+    int game = recent_games_get_order(HISTORY_VIEW_RECENT)[0];
+    char core_name[256];
+    char directory[256];
+    char filename[256];
+    snprintf(core_name, sizeof(core_name), "%s", recent_games_get_core_name(game));
+    snprintf(directory, sizeof(directory), "%s", recent_games_get_full_path(game));
+    snprintf(filename, sizeof(filename), "%s", recent_games_get_game_name(game));
 
-    init_direct_loader(game->core_name, game->full_path, game->game_name);
+    init_direct_loader(core_name, directory, filename);
 }
 
-// Get scrolling display text for selected item
-static void get_scrolling_text(const char *full_name, int is_selected, char *display_name, size_t display_size) {
+// Copy up to count UTF-8 characters of src, never splitting a character
+static void copy_utf8_chars(char *dst, size_t dst_size, const char *src, int count) {
+    size_t len = font_utf8_skip(src, count) - src;
+    if (len >= dst_size) len = dst_size - 1;
+    while (len > 0 && ((unsigned char)src[len] & 0xC0) == 0x80) len--;
+    memcpy(dst, src, len);
+    dst[len] = '\0';
+}
+
+// Get display text for an unselected item, truncated to fit beside the
+// thumbnail. Lengths count characters, not bytes, so UTF-8 names are never
+// cut mid-character. Selected items get the full name (see render_menu_item()).
+static void get_display_text(const char *full_name, char *display_name, size_t display_size) {
     if (!full_name || !display_name) return;
 
-    int name_len = strlen(full_name);
+    int name_len = font_utf8_length(full_name);
 
     // Check if we're in main menu or special views (no thumbnails)
     int in_main_menu = (strcmp(current_path, ROMS_PATH) == 0 ||
@@ -476,51 +561,15 @@ static void get_scrolling_text(const char *full_name, int is_selected, char *dis
                         strcmp(current_path, "HOTKEYS") == 0 ||
                         strcmp(current_path, "CREDITS") == 0);
 
-    // Use different max lengths: shorter for unselected items only in ROM lists (with thumbnails)
-    int max_len = is_selected ? MAX_FILENAME_DISPLAY_LEN :
-                  (in_main_menu ? MAX_FILENAME_DISPLAY_LEN : MAX_UNSELECTED_DISPLAY_LEN);
+    // Use shorter max length only in ROM lists (with thumbnails)
+    int max_len = in_main_menu ? MAX_FILENAME_DISPLAY_LEN : MAX_UNSELECTED_DISPLAY_LEN;
 
-    // If short enough or not selected, just copy/truncate normally
-    if (name_len <= max_len || !is_selected) {
-        if (name_len <= max_len) {
-            strcpy(display_name, full_name);
-        } else {
-            strncpy(display_name, full_name, max_len);
-            display_name[max_len] = '\0';
-            strcat(display_name, "...");
-        }
-        return;
-    }
-    
-    // Handle scrolling for selected long names
-    text_scroll_frame_counter++;
-    
-    // Wait before starting scroll
-    if (text_scroll_frame_counter < SCROLL_DELAY_FRAMES) {
-        strncpy(display_name, full_name, MAX_FILENAME_DISPLAY_LEN);
-        display_name[MAX_FILENAME_DISPLAY_LEN] = '\0';
-        return;
-    }
-    
-    // Update scroll position
-    if (text_scroll_frame_counter % SCROLL_SPEED_FRAMES == 0) {
-        text_scroll_offset += text_scroll_direction;
-        
-        // Reverse direction at ends
-        int max_scroll = name_len - MAX_FILENAME_DISPLAY_LEN;
-        if (text_scroll_offset >= max_scroll) {
-            text_scroll_direction = -1;
-            text_scroll_offset = max_scroll;
-        } else if (text_scroll_offset <= 0) {
-            text_scroll_direction = 1;
-            text_scroll_offset = 0;
-        }
+    if (name_len <= max_len) {
+        copy_utf8_chars(display_name, display_size, full_name, name_len);
+    } else {
+        copy_utf8_chars(display_name, display_size - 3, full_name, max_len);
+        strcat(display_name, "...");
     }
-    
-    // Extract scrolled portion
-    int copy_len = min(MAX_FILENAME_DISPLAY_LEN, name_len - text_scroll_offset);
-    strncpy(display_name, full_name + text_scroll_offset, copy_len);
-    display_name[copy_len] = '\0';
 }
 
 // Load thumbnail for currently selected item
@@ -531,7 +580,7 @@ static void load_current_thumbnail() {
     }
     
     // Only load thumbnails for files, not directories
-    if (entries[selected_index].is_dir) {
+    if (entry_at(selected_index)->is_dir) {
         thumbnail_cache_valid = 0;
         return;
     }
@@ -540,15 +589,12 @@ static void load_current_thumbnail() {
     
     // Check if we're in Recent games mode
     if (strcmp(current_path, "RECENT_GAMES") == 0) {
-        // For recent games, we need to use the full_path from the RecentGame structure
-        const RecentGame* recent_list = recent_games_get_list();
-        int recent_count = recent_games_get_count();
-
-        if (selected_index < recent_count) {
-            const RecentGame *recent_game = &recent_list[selected_index];
+        // For recent games, we need to use the full_path of the game on this row
+        if (selected_index < row_order_count) {
+            const char *full_path = recent_games_get_full_path(row_order[selected_index]);
 
-            if (recent_game->full_path[0] != '\0') {
-                get_thumbnail_path(recent_game->full_path, thumb_path, sizeof(thumb_path));
+            if (full_path[0] != '\0') {
+                get_thumbnail_path(full_path, thumb_path, sizeof(thumb_path));
             } else {
                 // No full path available, skip thumbnail
                 thumbnail_cache_valid = 0;
@@ -560,15 +606,12 @@ static void load_current_thumbnail() {
             return;
         }
     } else if (strcmp(current_path, "FAVORITES") == 0) {
-        // For favorites, we need to use the full_path from the FavoriteGame structure
-        const FavoriteGame* favorites_list = favorites_get_list();
-        int favorites_count = favorites_get_count();
-
-        if (selected_index < favorites_count) {
-            const FavoriteGame *favorite_game = &favorites_list[selected_index];
+        // For favorites, we need to use the full_path of the favorite on this row
+        if (selected_index < row_order_count) {
+            const char *full_path = favorites_get_full_path(row_order[selected_index]);
 
-            if (favorite_game->full_path[0] != '\0') {
-                get_thumbnail_path(favorite_game->full_path, thumb_path, sizeof(thumb_path));
+            if (full_path[0] != '\0') {
+                get_thumbnail_path(full_path, thumb_path, sizeof(thumb_path));
             } else {
                 // No full path available, skip thumbnail
                 thumbnail_cache_valid = 0;
@@ -581,7 +624,7 @@ static void load_current_thumbnail() {
         }
     } else {
         // Regular file browser mode
-        get_thumbnail_path(entries[selected_index].path, thumb_path, sizeof(thumb_path));
+        get_thumbnail_path(entry_at(selected_index)->path, thumb_path, sizeof(thumb_path));
     }
     
     // Check if we already have this thumbnail cached
@@ -614,7 +657,7 @@ static inline int is_directory_fast(const char *path, unsigned char d_type) {
 
     // Fallback to stat only if needed
     struct stat st;
-    if (stat(path, &st) == 0) {
+    if (vfs_stat(path, &st) == 0) {
         return S_ISDIR(st.st_mode);
     }
     return 0;
@@ -627,6 +670,40 @@ int compare_entries(const void *a, const void *b) {
     return strcmp(entry_a->name, entry_b->name);  // Compare by name
 }
 
+// Show only the files of a ROM folder that were never launched, or every
+// entry again
+static void toggle_never_played(void) {
+    if (row_order) {
+        // Keep the selected entry selected
+        selected_index = row_order[selected_index];
+        entry_count = all_entry_count;
+        row_order = NULL;
+        row_order_count = 0;
+        row_order_name = NULL;
+        return;
+    }
+
+    if (unplayed_capacity < entry_count) {
+        int *rows = (int*)realloc(unplayed_rows, entries_capacity * sizeof(int));
+        if (!rows) return;
+        unplayed_rows = rows;
+        unplayed_capacity = entries_capacity;
+    }
+
+    // Folders, including "..", stay so the filter can be browsed
+    int rows = 0;
+    for (int i = 0; i < entry_count; i++) {
+        if (entries[i].is_dir || !entries[i].is_played) unplayed_rows[rows++] = i;
+    }
+
+    all_entry_count = entry_count;
+    entry_count = rows;
+    row_order = unplayed_rows;
+    row_order_count = rows;
+    row_order_name = "NEVER PLAYED";
+    selected_index = 0;
+}
+
 // Show recent games list
 static void show_recent_games(void) {
     entry_count = 0;
@@ -639,33 +716,22 @@ static void show_recent_games(void) {
     // Clear thumbnail cache when switching to recent games mode
     thumbnail_cache_valid = 0;
 
-    const RecentGame* recent_list = recent_games_get_list();
     int recent_count = recent_games_get_count();
 
-    if (recent_count == 0) {
-        // Only show back entry if no recent games
-        ensure_entries_capacity(entry_count + 1);
-        strncpy(entries[entry_count].name, "..", sizeof(entries[entry_count].name) - 1);
-        strncpy(entries[entry_count].path, ROMS_PATH, sizeof(entries[entry_count].path) - 1);
-        entries[entry_count].is_dir = 1;
-        entry_count++;
-    } else {
-        // Add recent games first
-        ensure_entries_capacity(entry_count + recent_count + 1);
-        for (int i = 0; i < recent_count; i++) {
-            strncpy(entries[entry_count].name, recent_list[i].display_name, sizeof(entries[entry_count].name) - 1);
-            snprintf(entries[entry_count].path, sizeof(entries[entry_count].path),
-                    "%s;%s", recent_list[i].core_name, recent_list[i].game_name);
-            entries[entry_count].is_dir = 0;
-            entry_count++;
-        }
+    // The back entry, shown after the recent games
+    ensure_entries_capacity(1 + RECENT_ROW_SLOTS);
+    strncpy(entries[0].name, "..", sizeof(entries[0].name) - 1);
+    strncpy(entries[0].path, ROMS_PATH, sizeof(entries[0].path) - 1);
+    entries[0].is_dir = 1;
 
-        // Add back entry after recent games
-        strncpy(entries[entry_count].name, "..", sizeof(entries[entry_count].name) - 1);
-        strncpy(entries[entry_count].path, ROMS_PATH, sizeof(entries[entry_count].path) - 1);
-        entries[entry_count].is_dir = 1;
-        entry_count++;
+    if (recent_count > 0) {
+        for (int i = 0; i < RECENT_ROW_SLOTS; i++) recent_slot_game[i] = -1;
+        recent_rows_on_demand = 1;
+        row_order = recent_games_get_order(history_view);
+        row_order_count = recent_count;
+        row_order_name = recent_games_view_name(history_view);
     }
+    entry_count = recent_count + 1;
     
     // Load thumbnail for initially selected item AND reset last_selected_index to prevent duplicate loading
     load_current_thumbnail();
@@ -684,7 +750,6 @@ static void show_favorites(void) {
     // Clear thumbnail cache when switching to favorites mode
     thumbnail_cache_valid = 0;
 
-    const FavoriteGame* favorites_list = favorites_get_list();
     int favorites_count = favorites_get_count();
 
     if (favorites_count == 0) {
@@ -695,15 +760,19 @@ static void show_favorites(void) {
         entries[entry_count].is_dir = 1;
         entry_count++;
     } else {
-        // Add favorites first
+        // Add favorites first, in the order they were added
         ensure_entries_capacity(entry_count + favorites_count + 1);
         for (int i = 0; i < favorites_count; i++) {
-            strncpy(entries[entry_count].name, favorites_list[i].display_name, sizeof(entries[entry_count].name) - 1);
+            snprintf(entries[entry_count].name, sizeof(entries[entry_count].name),
+                    "%s (%s)", favorites_get_game_name(i), favorites_get_core_name(i));
             snprintf(entries[entry_count].path, sizeof(entries[entry_count].path),
-                    "%s;%s", favorites_list[i].core_name, favorites_list[i].game_name);
+                    "%s;%s", favorites_get_core_name(i), favorites_get_game_name(i));
             entries[entry_count].is_dir = 0;
             entry_count++;
         }
+        row_order = favorites_get_order(favorites_sort);
+        row_order_count = favorites_count;
+        row_order_name = favorites_sort_name(favorites_sort);
 
         // Add back entry after favorites
         strncpy(entries[entry_count].name, "..", sizeof(entries[entry_count].name) - 1);
@@ -729,8 +798,8 @@ static void show_tools_menu(void) {
     // Clear thumbnail cache when switching to tools mode
     thumbnail_cache_valid = 0;
 
-    // Ensure we have space for 4 entries
-    ensure_entries_capacity(4);
+    // Ensure we have space for 5 entries
+    ensure_entries_capacity(5);
 
     // Add Hotkeys entry
     strncpy(entries[entry_count].name, "Hotkeys", sizeof(entries[entry_count].name) - 1);
@@ -750,6 +819,12 @@ static void show_tools_menu(void) {
     entries[entry_count].is_dir = 1;
     entry_count++;
 
+    // Add I/O stats entry
+    strncpy(entries[entry_count].name, "I/O stats", sizeof(entries[entry_count].name) - 1);
+    strncpy(entries[entry_count].path, "IO_STATS", sizeof(entries[entry_count].path) - 1);
+    entries[entry_count].is_dir = 1;
+    entry_count++;
+
     // Add back entry
     strncpy(entries[entry_count].name, "..", sizeof(entries[entry_count].name) - 1);
     strncpy(entries[entry_count].path, ROMS_PATH, sizeof(entries[entry_count].path) - 1);
@@ -777,17 +852,17 @@ static void show_utils_menu(void) {
     char js2000_path[MAX_PATH_LEN];
     snprintf(js2000_path, sizeof(js2000_path), "%s/js2000", ROMS_PATH);
 
-    DIR *dir = opendir(js2000_path);
+    DIR *dir = vfs_opendir(js2000_path);
     if (dir) {
         struct dirent *ent;
-        while ((ent = readdir(dir)) != NULL) {
+        while ((ent = vfs_readdir(dir)) != NULL) {
             if (ent->d_name[0] == '.') continue;  // Skip hidden files
 
             char full_path[MAX_PATH_LEN];
             snprintf(full_path, sizeof(full_path), "%s/%s", js2000_path, ent->d_name);
 
             struct stat st;
-            if (stat(full_path, &st) == 0) {
+            if (vfs_stat(full_path, &st) == 0) {
                 ensure_entries_capacity(entry_count + 1);
                 strncpy(entries[entry_count].name, ent->d_name, sizeof(entries[entry_count].name) - 1);
                 strncpy(entries[entry_count].path, full_path, sizeof(entries[entry_count].path) - 1);
@@ -795,7 +870,7 @@ static void show_utils_menu(void) {
                 entry_count++;
             }
         }
-        closedir(dir);
+        vfs_closedir(dir);
     }
 
     // Add "Rebuild folder cache" option
@@ -841,10 +916,23 @@ static void show_credits_screen(void) {
     reset_navigation_state();
 }
 
+// Show I/O stats screen
+static void show_io_stats_screen(void) {
+    // Set current_path for I/O stats mode
+    strncpy(current_path, "IO_STATS", sizeof(current_path) - 1);
+    current_path[sizeof(current_path) - 1] = '\0';
+
+    // Clear thumbnail cache and entries for I/O stats mode
+    thumbnail_cache_valid = 0;
+    entry_count = 0;
+    reset_navigation_state();
+}
+
 // Scan directory and populate entries
 static void scan_directory(const char *path) {
     DIR *dir;
     struct dirent *ent;
+    uint32_t profile_start = profile_begin();
 
     entry_count = 0;
     reset_navigation_state();
@@ -852,22 +940,33 @@ static void scan_directory(const char *path) {
     // Store whether we're at root for recent games insertion later
     int is_root = (strcmp(path, ROMS_PATH) == 0);
 
+    // Favorites and play history are keyed by the folder relative to ROMS,
+    // the same for every file here, so each file costs two hash lookups.
+    // A folder too deep for a key has no favorite or played flags.
+    char key_dir[MAX_PATH_LEN + 1];
+    int has_keys = !is_root && snprintf(key_dir, sizeof(key_dir), "%s/", path) < (int)sizeof(key_dir);
+    if (has_keys) clean_path(key_dir);
+    entries_have_favorites = has_keys;
+
     // Add parent directory entry if not at root
     if (!is_root) {
         ensure_entries_capacity(entry_count + 1);
         strncpy(entries[entry_count].name, "..", sizeof(entries[entry_count].name) - 1);
         strncpy(entries[entry_count].path, path, sizeof(entries[entry_count].path) - 1);
         entries[entry_count].is_dir = 1;
+        entries[entry_count].is_favorite = 0;
+        entries[entry_count].is_played = 0;
         entry_count++;
     }
 
-    dir = opendir(path);
+    dir = vfs_opendir(path);
     if (!dir) {
+        profile_end(PROFILE_SCAN, profile_start);
         return;
     }
 
     // Collect all entries in a single pass - optimized
-    while ((ent = readdir(dir)) != NULL) {
+    while ((ent = vfs_readdir(dir)) != NULL) {
         if (ent->d_name[0] == '.') continue;  // Skip hidden files
 
         // Skip frogui, and saves folders
@@ -912,21 +1011,27 @@ static void scan_directory(const char *path) {
             strncpy(entries[entry_count].name, entry_name, sizeof(entries[entry_count].name) - 1);
             strncpy(entries[entry_count].path, full_path, sizeof(entries[entry_count].path) - 1);
             entries[entry_count].is_dir = 1;
+            entries[entry_count].is_favorite = 0;
+            entries[entry_count].is_played = 0;
             entry_count++;
         } else {
             // Add file entry
             strncpy(entries[entry_count].name, entry_name, sizeof(entries[entry_count].name) - 1);
             strncpy(entries[entry_count].path, full_path, sizeof(entries[entry_count].path) - 1);
             entries[entry_count].is_dir = 0;
+            entries[entry_count].is_favorite = has_keys && favorites_is_favorited(key_dir, entry_name);
+            entries[entry_count].is_played = has_keys && recent_games_find(key_dir, entry_name) >= 0;
             entry_count++;
         }
     }
 
     // Close the directory after reading
-    closedir(dir);
+    vfs_closedir(dir);
 
     // Sort all entries alphabetically by name
+    uint32_t sort_start = profile_begin();
     qsort(entries, entry_count, sizeof(MenuEntry), compare_entries);
+    profile_end(PROFILE_SORT, sort_start);
 
     // Add Recent games at the very top if in root directory
     if (is_root) {
@@ -977,6 +1082,8 @@ static void scan_directory(const char *path) {
     // The render loop will handle loading thumbnails on the first frame
     thumbnail_cache_valid = 0;
     last_selected_index = -1;  // Force load on first render
+
+    profile_end(PROFILE_SCAN, profile_start);
 }
 
 // Render settings menu
@@ -993,8 +1100,7 @@ static void render_settings_menu() {
     }
 
     // Draw title
-    if (show_multicore_opt) font_draw_text(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, PADDING, 10, "MULTICORE SETTINGS", COLOR_HEADER);
-    else font_draw_text(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, PADDING, 10, "CORE SETTINGS", COLOR_HEADER);
+    render_header(framebuffer, show_multicore_opt ? "MULTICORE SETTINGS" : "CORE SETTINGS");
 
     // Draw the label in top-right
     char entry_label[20];
@@ -1002,7 +1108,7 @@ static void render_settings_menu() {
     int label_width = font_measure_text(entry_label);
     int label_x = SCREEN_WIDTH - label_width - 12;  // Right-aligned, just above the legend
     int label_y = 8;  // Position it slightly below the top edge
-    render_text_pillbox(framebuffer, label_x, label_y, entry_label, COLOR_LEGEND_BG, COLOR_LEGEND, 6);
+    render_label_pillbox(framebuffer, label_x, label_y, entry_label, COLOR_LEGEND_BG, COLOR_LEGEND, 6);
 
     int settings_count = settings_get_count();
     int start_y = 40;
@@ -1048,14 +1154,13 @@ static void render_settings_menu() {
     int legend_x = SCREEN_WIDTH - legend_width - 12;
 
     // Draw legend pill with rounded corners
-    render_rounded_rect(framebuffer, legend_x - 4, legend_y - 2, legend_width + 8, 20, 10, COLOR_LEGEND_BG);
-    font_draw_text(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, legend_x, legend_y, legend, COLOR_LEGEND);
+    render_legend_pill(framebuffer, legend_x, legend_y, legend);
 }
 
 // Render hotkeys screen
 static void render_hotkeys_screen() {
     // Draw title
-    font_draw_text(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, PADDING, 10, "HOTKEYS", COLOR_HEADER);
+    render_header(framebuffer, "HOTKEYS");
 
     // Draw hotkey information
     int start_y = 50;
@@ -1074,14 +1179,13 @@ static void render_hotkeys_screen() {
     int legend_width = font_measure_text(legend);
     int legend_x = SCREEN_WIDTH - legend_width - 12;
     
-    render_rounded_rect(framebuffer, legend_x - 4, legend_y - 2, legend_width + 8, 20, 10, COLOR_LEGEND_BG);
-    font_draw_text(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, legend_x, legend_y, legend, COLOR_LEGEND);
+    render_legend_pill(framebuffer, legend_x, legend_y, legend);
 }
 
 // Render credits screen
 static void render_credits_screen() {
     // Draw title
-    font_draw_text(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, PADDING, 10, "CREDITS", COLOR_HEADER);
+    render_header(framebuffer, "CREDITS");
     
     // Draw credits information
     int start_y = 50;
@@ -1110,8 +1214,38 @@ static void render_credits_screen() {
     int legend_width = font_measure_text(legend);
     int legend_x = SCREEN_WIDTH - legend_width - 12;
     
-    render_rounded_rect(framebuffer, legend_x - 4, legend_y - 2, legend_width + 8, 20, 10, COLOR_LEGEND_BG);
-    font_draw_text(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, legend_x, legend_y, legend, COLOR_LEGEND);
+    render_legend_pill(framebuffer, legend_x, legend_y, legend);
+}
+
+// Render I/O stats screen - SD card calls and bytes of the last action of each kind
+static void render_io_stats_screen() {
+    render_header(framebuffer, "I/O STATS");
+
+    int start_y = 50;
+    int line_height = 24;
+    int calls_right = 210;  // Right edges of the two number columns
+    int kb_right = SCREEN_WIDTH - PADDING;
+
+    for (int i = 0; i < VFS_ACTION_COUNT; i++) {
+        const VfsStats *stats = vfs_get_last((VfsAction)i);
+        int y = start_y + line_height * i;
+        char calls[24];
+        char kb[24];
+        snprintf(calls, sizeof(calls), "%u CALLS", (unsigned)vfs_total_calls(stats));
+        snprintf(kb, sizeof(kb), "%u KB", (unsigned)((stats->bytes_read + stats->bytes_written + 1023) / 1024));
+
+        font_draw_text(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, PADDING, y, vfs_action_name((VfsAction)i), COLOR_TEXT);
+        font_draw_text(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, calls_right - font_measure_text(calls), y, calls, COLOR_TEXT);
+        font_draw_text(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, kb_right - font_measure_text(kb), y, kb, COLOR_TEXT);
+    }
+
+    // Draw legend
+    const char *legend = " B - BACK ";
+    int legend_y = SCREEN_HEIGHT - 24;
+    int legend_width = font_measure_text(legend);
+    int legend_x = SCREEN_WIDTH - legend_width - 12;
+
+    render_legend_pill(framebuffer, legend_x, legend_y, legend);
 }
 
 void clean_path(char *path)
@@ -1133,6 +1267,8 @@ void clean_path(char *path)
 
 // Render the menu using modular render system
 static void render_menu() {
+    // Only the plain list re-arms the marquee
+    render_marquee_stop();
     render_clear_screen(framebuffer);
 
     // If game is queued, just show loading screen
@@ -1166,10 +1302,22 @@ static void render_menu() {
         return;
     }
 
+    // If in I/O stats mode, render I/O stats screen
+    if (strcmp(current_path, "IO_STATS") == 0) {
+        render_io_stats_screen();
+        return;
+    }
+
     // Draw header with current folder name
+    char view_title[MAX_PATH_LEN + 32];  // Folder name, ": " and the view name
     const char *display_path = current_path;
     if (strcmp(current_path, ROMS_PATH) == 0) {
         display_path = "FROGUI: SYSTEMS";  // Marketing branding
+    } else if (row_order_name && strcmp(current_path, "RECENT_GAMES") == 0) {
+        display_path = row_order_name;  // "RECENTLY PLAYED" or "MOST PLAYED"
+    } else if (row_order_name) {
+        snprintf(view_title, sizeof(view_title), "%s: %s", get_basename(current_path), row_order_name);
+        display_path = view_title;
     } else {
         // Show just the folder name, not full path
         display_path = get_basename(current_path);
@@ -1186,12 +1334,12 @@ static void render_menu() {
     // Load and display thumbnail for selected item FIRST (background layer)
     // Only reload if selection changed
     if (last_selected_index != selected_index) {
+        uint32_t profile_start = profile_begin();
         load_current_thumbnail();
+        profile_end(PROFILE_THUMB, profile_start);
         last_selected_index = selected_index;
-        // Reset scrolling state for new selection
-        text_scroll_frame_counter = 0;
-        text_scroll_offset = 0;
-        text_scroll_direction = 1;
+        // Restart the marquee for the new selection
+        render_marquee_reset();
     }
     
     if (thumbnail_cache_valid) {
@@ -1200,33 +1348,19 @@ static void render_menu() {
 
     // Draw menu entries ON TOP of thumbnail
     for (int i = scroll_offset; i < entry_count && i < scroll_offset + VISIBLE_ENTRIES; i++) {
-        // Get display name (with scrolling for selected item)
-        char display_name[MAX_FILENAME_DISPLAY_LEN + 4];
-        get_scrolling_text(entries[i].name, (i == selected_index), display_name, sizeof(display_name));
-
-        // Check if this item is favorited
-        int is_favorited = 0;
-        if (!entries[i].is_dir &&
-            strcmp(current_path, ROMS_PATH) != 0 &&
-            strcmp(current_path, "RECENT_GAMES") != 0 &&
-            strcmp(current_path, "FAVORITES") != 0 &&
-            strcmp(current_path, "TOOLS") != 0 &&
-            strcmp(current_path, "UTILS") != 0 &&
-            strcmp(current_path, "HOTKEYS") != 0 &&
-            strcmp(current_path, "CREDITS") != 0) {
-            
-            char filename[256];
-            char directory[256];
-            strcpy(directory, entries[i].path);
-            clean_path(directory);
-            char *filename_path = strrchr(entries[i].path, '/');
-            if (filename_path) snprintf(filename, sizeof(filename), "%s", filename_path + 1);
-            else snprintf(filename, sizeof(filename), "%s", entries[i].name);
-
-            is_favorited = favorites_is_favorited(directory, filename);
+        // Get display name (the selected item scrolls its full name)
+        char display_name[MAX_FILENAME_DISPLAY_LEN * 4 + 4]; // Up to 4 UTF-8 bytes per character
+        const MenuEntry *entry = entry_at(i);
+        const char *item_name = entry->name;
+        if (i != selected_index) {
+            get_display_text(entry->name, display_name, sizeof(display_name));
+            item_name = display_name;
         }
 
-        render_menu_item(framebuffer, i, display_name, entries[i].is_dir,
+        // Favorite flags are only kept for scanned ROM folders
+        int is_favorited = entries_have_favorites && entry->is_favorite;
+
+        render_menu_item(framebuffer, i, item_name, entry->is_dir,
                         (i == selected_index), scroll_offset, is_favorited);
     }
 
@@ -1246,7 +1380,8 @@ static void render_menu() {
     }
     render_legend(framebuffer, x_button_mode);
 
-    // Draw the "current entry/total entries" label in top-right, above the legend
+    // Draw the "current entry/total entries" label in top-right, above the
+    // legend. It changes with every move, so it isn't worth caching.
     char entry_label[20];
     snprintf(entry_label, sizeof(entry_label), "%d/%d", selected_index + 1, entry_count); // 1-based indexing for display
     int label_width = font_measure_text(entry_label);
@@ -1256,6 +1391,9 @@ static void render_menu() {
 
     // Draw A-Z picker overlay if active
     if (az_picker_active) {
+        // The picker covers the list, keep the marquee from drawing over it
+        render_marquee_stop();
+
         // Draw centered background box using theme background color
         int box_width = 280;
         int box_height = 180;
@@ -1267,7 +1405,7 @@ static void render_menu() {
         const char *title = "QUICK JUMP";
         int title_width = font_measure_text(title);
         int title_x = (SCREEN_WIDTH - title_width) / 2;
-        render_text_pillbox(framebuffer, title_x, 30, title, COLOR_SELECT_BG, COLOR_SELECT_TEXT, 6);
+        render_label_pillbox(framebuffer, title_x, 30, title, COLOR_SELECT_BG, COLOR_SELECT_TEXT, 6);
 
         // Draw A-Z grid (7 columns x 4 rows = 28 slots)
         const char *labels[] = {
@@ -1387,276 +1525,6 @@ static void pick_random_game(void) {
     scan_directory(current_path);
 }
 
-/* =========================
-   WAV STRUCT + HELPERS
-   ========================= */
-
-typedef struct {
-    int sample_rate;
-    int channels;
-    int bits_per_sample;
-    int num_samples;
-    uint8_t *data;
-} Wav;
-
-static int read_le32(const uint8_t *p)
-{
-    return p[0] | (p[1] << 8) | (p[2] << 16) | (p[3] << 24);
-}
-
-static int read_le16(const uint8_t *p)
-{
-    return p[0] | (p[1] << 8);
-}
-
-bool wav_load(const uint8_t *buf, size_t size, Wav *out)
-{
-    if (size < 44) return false;
-    if (memcmp(buf, "RIFF", 4) || memcmp(buf + 8, "WAVE", 4))
-        return false;
-
-    int pos = 12;
-
-    while (pos + 8 <= (int)size)
-    {
-        int chunk_size = read_le32(buf + pos + 4);
-
-        if (!memcmp(buf + pos, "fmt ", 4))
-        {
-            int format = read_le16(buf + pos + 8);
-            out->channels = read_le16(buf + pos + 10);
-            out->sample_rate = read_le32(buf + pos + 12);
-            out->bits_per_sample = read_le16(buf + pos + 22);
-            if (format != 1) return false; /* PCM only */
-        }
-        else if (!memcmp(buf + pos, "data", 4))
-        {
-            out->data = (uint8_t *)(buf + pos + 8);
-            out->num_samples = chunk_size /
-                (out->channels * (out->bits_per_sample / 8));
-            return true;
-        }
-
-        pos += 8 + chunk_size;
-    }
-
-    return false;
-}
-
-/* =========================
-   FILE LOADER
-   ========================= */
-
-bool load_file(const char *path, uint8_t **out_data, size_t *out_size)
-{
-    FILE *f = fopen(path, "rb");
-    if (!f) return false;
-
-    fseek(f, 0, SEEK_END);
-    long size = ftell(f);
-    fseek(f, 0, SEEK_SET);
-
-    uint8_t *data = (uint8_t *)malloc(size);
-    fread(data, 1, size, f);
-    fclose(f);
-
-    *out_data = data;
-    *out_size = size;
-    return true;
-}
-
-/* =========================
-   AUDIO ENGINE
-   ========================= */
-
-#define AUDIO_FRAMES 1024
-#define MAX_SFX 8
-
-typedef struct {
-    const Wav *wav;
-    int pos;
-    int volume;   /* 0–256 */
-    bool active;
-} SfxVoice;
-
-/* --- BGM --- */
-static const Wav *bgm_wav = NULL;
-static int bgm_pos = 0;
-static int bgm_volume = 128;
-static bool bgm_playing = false;
-
-/* --- SFX --- */
-static SfxVoice sfx[MAX_SFX];
-
-/* =========================
-   CONTROL FUNCTIONS
-   ========================= */
-
-void bgm_play(const Wav *wav, int volume)
-{
-    bgm_wav = wav;
-    bgm_pos = 0;
-    bgm_volume = volume;
-    bgm_playing = true;
-}
-
-void bgm_stop(void)
-{
-    bgm_playing = false;
-}
-
-void sfx_play(const Wav *wav, int volume)
-{
-    for (int i = 0; i < MAX_SFX; i++)
-    {
-        if (!sfx[i].active)
-        {
-            sfx[i].wav = wav;
-            sfx[i].pos = 0;
-            sfx[i].volume = volume;
-            sfx[i].active = true;
-            return;
-        }
-    }
-}
-
-/* =========================
-   MIXER
-   ========================= */
-
-static inline int16_t clamp16(int v)
-{
-    if (v > 32767) return 32767;
-    if (v < -32768) return -32768;
-    return v;
-}
-
-void output_wav_audio(void)
-{
-    if (!audio_batch_cb)
-        return;
-
-    int16_t buffer[AUDIO_FRAMES * 2] = {0};
-
-    for (int i = 0; i < AUDIO_FRAMES; i++)
-    {
-        int mix_l = 0;
-        int mix_r = 0;
-
-        /* --- BGM (looping) --- */
-        if (bgm_playing && bgm_wav)
-        {
-            if (bgm_pos >= bgm_wav->num_samples)
-                bgm_pos = 0;
-
-            int16_t l = 0, r = 0;
-
-            if (bgm_wav->bits_per_sample == 16)
-            {
-                int16_t *pcm = (int16_t *)bgm_wav->data;
-                if (bgm_wav->channels == 1)
-                    l = r = pcm[bgm_pos];
-                else {
-                    l = pcm[bgm_pos * 2 + 0];
-                    r = pcm[bgm_pos * 2 + 1];
-                }
-            }
-            else
-            {
-                uint8_t *pcm = bgm_wav->data;
-                if (bgm_wav->channels == 1)
-                    l = r = ((int)pcm[bgm_pos] - 128) << 8;
-                else {
-                    l = ((int)pcm[bgm_pos * 2 + 0] - 128) << 8;
-                    r = ((int)pcm[bgm_pos * 2 + 1] - 128) << 8;
-                }
-            }
-
-            mix_l += (l * bgm_volume) >> 8;
-            mix_r += (r * bgm_volume) >> 8;
-            bgm_pos++;
-        }
-
-        /* --- SFX (one-shot) --- */
-        for (int v = 0; v < MAX_SFX; v++)
-        {
-            SfxVoice *vc = &sfx[v];
-            if (!vc->active) continue;
-
-            if (vc->pos >= vc->wav->num_samples)
-            {
-                vc->active = false;
-                continue;
-            }
-
-            int16_t l = 0, r = 0;
-
-            if (vc->wav->bits_per_sample == 16)
-            {
-                int16_t *pcm = (int16_t *)vc->wav->data;
-                if (vc->wav->channels == 1)
-                    l = r = pcm[vc->pos];
-                else {
-                    l = pcm[vc->pos * 2 + 0];
-                    r = pcm[vc->pos * 2 + 1];
-                }
-            }
-            else
-            {
-                uint8_t *pcm = vc->wav->data;
-                if (vc->wav->channels == 1)
-                    l = r = ((int)pcm[vc->pos] - 128) << 8;
-                else {
-                    l = ((int)pcm[vc->pos * 2 + 0] - 128) << 8;
-                    r = ((int)pcm[vc->pos * 2 + 1] - 128) << 8;
-                }
-            }
-
-            mix_l += (l * vc->volume) >> 8;
-            mix_r += (r * vc->volume) >> 8;
-            vc->pos++;
-        }
-
-        buffer[i * 2 + 0] = clamp16(mix_l);
-        buffer[i * 2 + 1] = clamp16(mix_r);
-    }
-
-    audio_batch_cb(buffer, AUDIO_FRAMES);
-}
-
-static Wav bgm;
-static uint8_t *bgm_file;
-static size_t bgm_file_size;
-
-void audio_init(void) {
-    if (!load_file("/mnt/sda1/frogui/menu_music.wav", &bgm_file, &bgm_file_size))
-        return;
-
-    if (!wav_load(bgm_file, bgm_file_size, &bgm))
-        return;
-
-    /* Start playing immediately */
-    bgm_play(&bgm, 128);  // volume: 0–256
-}
-
-static Wav nav;
-static uint8_t *nav_file;
-static size_t nav_file_size;
-bool nav_init_once = false;
-
-void navigation_sfx(void) {
-    if (!nav_init_once) {
-        if (!load_file("/mnt/sda1/frogui/navigation.wav", &nav_file, &nav_file_size))
-            return;
-
-        if (!wav_load(nav_file, nav_file_size, &nav))
-            return;
-    
-        nav_init_once = true;
-    }
-    sfx_play(&nav, 128);  // volume: 0–256
-}
-
 // Handle input
 static void handle_input() {
     if (!input_poll_cb || !input_state_cb) return;
@@ -1684,7 +1552,7 @@ static void handle_input() {
     int right = input_state_cb(0, RETRO_DEVICE_JOYPAD, 0, RETRO_DEVICE_ID_JOYPAD_RIGHT);
 
     if ((prev_input[0] && !up) || (prev_input[1] && !down) || (prev_input[7] && !left) || (prev_input[8] && !right)) { // Play audio for up down left and right
-        navigation_sfx();
+        audio_play_navigation();
     }
 
     // Flag to determine if the menu needs to be redrawn
@@ -1695,6 +1563,29 @@ static void handle_input() {
                         (prev_input[8] != right) || (prev_input[9] != x) || 
                         (prev_input[10] != y);
 
+    // Fold journals that grew long during the session back into their
+    // snapshots on a frame without input
+    if (!input_changed) {
+        favorites_compact();
+        recent_games_compact();
+    }
+
+    // Charge the I/O of a button release, and of the redraw it triggers, to its action
+    int move_released = (prev_input[0] && !up) || (prev_input[1] && !down) ||
+                        (prev_input[4] && !l) || (prev_input[5] && !r) ||
+                        (prev_input[7] && !left) || (prev_input[8] && !right);
+    int confirm_released = (prev_input[2] && !a) || (prev_input[3] && !b);
+    if ((prev_input[6] && !select) ||
+        (settings_is_active() && (move_released || confirm_released || (prev_input[10] && !y)))) {
+        vfs_begin_action(VFS_ACTION_SETTINGS);
+    } else if (confirm_released) {
+        vfs_begin_action(VFS_ACTION_ENTER);
+    } else if (prev_input[9] && !x) {
+        vfs_begin_action(VFS_ACTION_FAVORITE);
+    } else if (move_released) {
+        vfs_begin_action(VFS_ACTION_MOVE);
+    }
+
     // Handle SELECT button to open settings (on button release)
     if (prev_input[6] && !select) {
         if (settings_is_active()) show_multicore_opt = !show_multicore_opt;
@@ -1726,6 +1617,7 @@ static void handle_input() {
     // Check if settings menu should handle input
     if (settings_handle_input(prev_input[0] && !up, prev_input[1] && !down,
                             prev_input[7] && !left, prev_input[8] && !right,
+                            prev_input[4] && !l, prev_input[5] && !r,
                             prev_input[2] && !a, prev_input[3] && !b, prev_input[10] && !y)) {
         // Settings consumed the input, update prev_input and return
         prev_input[0] = up;
@@ -1772,7 +1664,7 @@ static void handle_input() {
 
             // Find first entry starting with this letter (case insensitive)
             for (int i = 0; i < entry_count; i++) {
-                char entry_first = entries[i].name[0];
+                char entry_first = entry_at(i)->name[0];
                 if (entry_first >= 'a' && entry_first <= 'z') {
                     entry_first = entry_first - 'a' + 'A'; // Convert to uppercase
                 }
@@ -1888,14 +1780,14 @@ static void handle_input() {
 
     // Handle X button (toggle favorite / remove from favorites) - on button release
     if (prev_input[9] && !x && entry_count > 0) {
-        MenuEntry *entry = &entries[selected_index];
+        MenuEntry *entry = entry_at(selected_index);
 
         // Handle removing from favorites when in FAVORITES view
         if (strcmp(current_path, "FAVORITES") == 0) {
             // Don't allow removing the ".." back entry
             if (!entry->is_dir && strcmp(entry->name, "..") != 0) {
-                // Remove this favorite by index
-                favorites_remove_by_index(selected_index);
+                // Remove the favorite on this row
+                favorites_remove_by_index(row_order[selected_index]);
 
                 // Refresh the favorites list
                 show_favorites();
@@ -1936,12 +1828,32 @@ static void handle_input() {
 
             // Toggle favorite
             favorites_toggle(core_name, filename, directory);
+            entry->is_favorite = favorites_is_favorited(directory, filename);
+        }
+    }
+
+    // Handle Y button (switch the order or filter of the list) - on button release
+    if (prev_input[10] && !y) {
+        if (strcmp(current_path, "FAVORITES") == 0 && row_order) {
+            favorites_sort = (FavoritesSort)((favorites_sort + 1) % FAVORITES_SORT_COUNT);
+            row_order = favorites_get_order(favorites_sort);
+            row_order_name = favorites_sort_name(favorites_sort);
+            selected_index = 0;
+        } else if (strcmp(current_path, "RECENT_GAMES") == 0 && row_order) {
+            history_view = (HistoryView)((history_view + 1) % HISTORY_VIEW_COUNT);
+            row_order = recent_games_get_order(history_view);
+            row_order_name = recent_games_view_name(history_view);
+            selected_index = 0;
+        } else if (entries_have_favorites) {
+            toggle_never_played();
         }
+        scroll_offset = 0;
+        last_selected_index = -1;  // Another game may be on the selected row now
     }
 
     // Handle A button (select) - on button release
     if (prev_input[2] && !a && entry_count > 0) {
-        MenuEntry *entry = &entries[selected_index];
+        MenuEntry *entry = entry_at(selected_index);
 
         if (strcmp(entry->name, "..") == 0) {
             // Go to parent directory
@@ -2000,6 +1912,9 @@ static void handle_input() {
                 // Show utils menu
                 show_utils_menu();
                 strncpy(current_path, "UTILS", sizeof(current_path) - 1);
+            } else if (strcmp(entry->path, "IO_STATS") == 0) {
+                // Show I/O stats screen
+                show_io_stats_screen();
             } else {
                 strncpy(current_path, entry->path, sizeof(current_path) - 1);
                 scan_directory(current_path);
@@ -2046,16 +1961,9 @@ static void handle_input() {
                 // Copy filename
                 snprintf(filename, sizeof(filename), "%s", separator + 1);
 
-                // For recent games, get the full_path from the RecentGame structure
-                const RecentGame* recent_list = recent_games_get_list();
-                int recent_count = recent_games_get_count();
-
-                for (int i = 0; i < recent_count; i++) {
-                    if (strcmp(recent_list[i].core_name, core_name) == 0 &&
-                        strcmp(recent_list[i].game_name, filename) == 0) {
-                        strcpy(directory, recent_list[i].full_path);
-                        break;
-                    }
+                // For recent games, get the full_path of the game on this row
+                if (selected_index < row_order_count) {
+                    snprintf(directory, sizeof(directory), "%s", recent_games_get_full_path(row_order[selected_index]));
                 }
             } else if (strcmp(current_path, "FAVORITES") == 0) {
                 // Parse core_name;game_name from entry->path
@@ -2075,16 +1983,9 @@ static void handle_input() {
                 // Copy filename
                 snprintf(filename, sizeof(filename), "%s", separator + 1);
 
-                // For favorites, get the full_path from the FavoriteGame structure
-                const FavoriteGame* favorites_list = favorites_get_list();
-                int favorites_count = favorites_get_count();
-
-                for (int i = 0; i < favorites_count; i++) {
-                    if (strcmp(favorites_list[i].core_name, core_name) == 0 &&
-                        strcmp(favorites_list[i].game_name, filename) == 0) {
-                        strcpy(directory, favorites_list[i].full_path);
-                        break;
-                    }
+                // For favorites, get the full_path of the favorite on this row
+                if (selected_index < row_order_count) {
+                    snprintf(directory, sizeof(directory), "%s", favorites_get_full_path(row_order[selected_index]));
                 }
             } else {
                 // Extract core name from parent directory
@@ -2155,6 +2056,9 @@ static void handle_input() {
             // Go back from Utils to Tools
             show_tools_menu();
             strncpy(current_path, "TOOLS", sizeof(current_path) - 1);
+        } else if (strcmp(current_path, "IO_STATS") == 0) {
+            // Go back from I/O stats to Tools
+            show_tools_menu();
         } else if (strcmp(current_path, ROMS_PATH) != 0) {
             // Remember which directory we're leaving so we can restore position
             char prev_dir[256];
@@ -2196,10 +2100,12 @@ static void handle_input() {
     prev_input[7] = left;
     prev_input[8] = right;
     prev_input[9] = x;
+    prev_input[10] = y;
 }
 
 // Libretro API implementation
 void retro_init(void) {
+    vfs_begin_action(VFS_ACTION_BOOT);
     framebuffer = (uint16_t*)malloc(SCREEN_WIDTH * SCREEN_HEIGHT * sizeof(uint16_t));
 
     // Seed random number generator for random game picker
@@ -2207,7 +2113,6 @@ void retro_init(void) {
 
     // Initialize modular systems
     render_init(framebuffer);
-    font_init();
     theme_init();
     recent_games_init();
     favorites_init();
@@ -2217,6 +2122,9 @@ void retro_init(void) {
     favorites_load();
     settings_load();
 
+    // After settings_load() so the configured font is the only one parsed
+    font_init();
+
     apply_settings();
 
     // Auto-launch most recent game if resume on boot is enabled
@@ -2229,7 +2137,7 @@ void retro_init(void) {
     }
     
     render_menu();
-    audio_init();
+    audio_init(environ_cb);
 }
 
 void retro_deinit(void) {
@@ -2247,6 +2155,12 @@ void retro_deinit(void) {
         entry_count = 0;
     }
 
+    free(unplayed_rows);
+    unplayed_rows = NULL;
+    unplayed_capacity = 0;
+
+    audio_deinit();
+
     if (framebuffer) {
         free(framebuffer);
         framebuffer = NULL;
@@ -2271,8 +2185,8 @@ void retro_get_system_info(struct retro_system_info *info) {
 }
 
 void retro_get_system_av_info(struct retro_system_av_info *info) {
-    info->timing.fps = 60.0;
-    info->timing.sample_rate = 44100.0;
+    info->timing.fps = AUDIO_FPS;
+    info->timing.sample_rate = AUDIO_SAMPLE_RATE;
 
     info->geometry.base_width   = SCREEN_WIDTH;
     info->geometry.base_height  = SCREEN_HEIGHT;
@@ -2321,11 +2235,22 @@ void retro_run(void) {
     if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE, &updated) && updated) {
       apply_settings();
     }
+    uint32_t frame_start = profile_begin();
+    uint32_t input_start = profile_begin();
     handle_input();
-    output_wav_audio();
+    profile_end(PROFILE_INPUT, input_start);
+    render_marquee_tick(framebuffer);
+    profile_draw_overlay(framebuffer);
+    uint32_t audio_start = profile_begin();
+    audio_run(audio_batch_cb);
+    profile_end(PROFILE_AUDIO, audio_start);
     if (video_cb) {
+        uint32_t blit_start = profile_begin();
         video_cb(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, SCREEN_WIDTH * sizeof(uint16_t));
+        profile_end(PROFILE_BLIT, blit_start);
     }
+    profile_end(PROFILE_FRAME, frame_start);
+    profile_frame_done();
     if (game_queued) {
         direct_loader(ptr_gs_run_game_file, 0);
         return;
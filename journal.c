@@ -0,0 +1,71 @@
+#include "journal.h"
+#include "vfs.h"
+#include <stdlib.h>
+#include <string.h>
+
+int journal_append(const char *journal_path, const char *record) {
+    FILE *fp = vfs_fopen(journal_path, "a");
+    if (!fp) return 0;
+
+    int ok = vfs_fputs(record, fp) != EOF && vfs_fputc('\n', fp) != EOF;
+    if (vfs_fclose(fp) != 0) ok = 0;
+    return ok;
+}
+
+int journal_replay(const char *journal_path, void (*apply)(char *record)) {
+    FILE *fp = vfs_fopen(journal_path, "rb");
+    if (!fp) return 0;
+
+    // Journals stay small, read them in one go
+    vfs_fseek(fp, 0, SEEK_END);
+    long size = vfs_ftell(fp);
+    vfs_fseek(fp, 0, SEEK_SET);
+
+    char *text = size > 0 ? (char*)malloc(size + 1) : NULL;
+    if (!text) {
+        vfs_fclose(fp);
+        return 0;
+    }
+    size = vfs_fread(text, 1, size, fp);
+    vfs_fclose(fp);
+
+    int records = 0;
+    char *record = text;
+    char *end = text + size;
+    while (record < end) {
+        char *newline = memchr(record, '\n', end - record);
+        if (!newline) {
+            // Torn last write
+            if (records < JOURNAL_COMPACT_RECORDS) records = JOURNAL_COMPACT_RECORDS;
+            break;
+        }
+
+        *newline = '\0';
+        if (newline > record && newline[-1] == '\r') newline[-1] = '\0';
+        if (*record) {
+            apply(record);
+            records++;
+        }
+        record = newline + 1;
+    }
+
+    free(text);
+    return records;
+}
+
+FILE *journal_open_snapshot(const char *snapshot_path, const char *temp_path) {
+    FILE *fp = vfs_fopen(snapshot_path, "r");
+    if (!fp) fp = vfs_fopen(temp_path, "r");
+    return fp;
+}
+
+int journal_commit(const char *snapshot_path, const char *temp_path, const char *journal_path) {
+    if (vfs_rename(temp_path, snapshot_path) != 0) {
+        // Some file systems won't rename over an existing file
+        vfs_remove(snapshot_path);
+        if (vfs_rename(temp_path, snapshot_path) != 0) return 0;
+    }
+
+    vfs_remove(journal_path);
+    return 1;
+}
@@ -0,0 +1,38 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <stdio.h>
+
+// Append-only record logs for small lists kept on the SD card (favorites,
+// recent games). A list lives in a snapshot file plus a journal of the
+// changes made since; a change costs one short append instead of rewriting
+// the snapshot. Loading replays the journal over the snapshot. Once the
+// journal grows past JOURNAL_COMPACT_RECORDS, at load or on an idle frame
+// during the session, the list is written back as a new snapshot and the
+// journal removed.
+//
+// Records are single text lines. A record only counts once its newline is
+// on the card, so a write cut short by a crash or power loss is ignored,
+// and replaying the journal over a snapshot that already contains it must
+// give the same list.
+
+#define JOURNAL_COMPACT_RECORDS 32
+
+// Append one record (without the newline). Returns 1 on success.
+int journal_append(const char *journal_path, const char *record);
+
+// Call apply for every complete record in the journal, in order. Returns
+// the number of records, 0 if there is no journal. A journal ending in a
+// torn write counts as JOURNAL_COMPACT_RECORDS, since the next append would
+// otherwise be joined to the partial line.
+int journal_replay(const char *journal_path, void (*apply)(char *record));
+
+// Open a snapshot for reading. If an interrupted commit left only the
+// temporary file, that is opened instead.
+FILE *journal_open_snapshot(const char *snapshot_path, const char *temp_path);
+
+// Replace a snapshot with the temporary file it was written to, then drop
+// the journal it absorbed. Returns 1 on success.
+int journal_commit(const char *snapshot_path, const char *temp_path, const char *journal_path);
+
+#endif // JOURNAL_H
@@ -0,0 +1,138 @@
+#include "profile.h"
+#include "render.h"
+#include "font.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifndef SF2000
+#include <time.h>
+#endif
+
+// The CP0 Count register ticks every other CPU cycle; the SF2000 CPU runs
+// at 918 MHz. Override with -DPROFILE_COUNT_MHZ=... for other clocks.
+#ifndef PROFILE_COUNT_MHZ
+#define PROFILE_COUNT_MHZ 459
+#endif
+
+static const char *stage_names[PROFILE_STAGE_COUNT] = {
+    "frame", "input", "scan", "sort", "thumb", "text", "blit", "audio"
+};
+
+static int profile_enabled = 0;
+
+// Time spent in each stage during the current frame
+static uint32_t frame_totals[PROFILE_STAGE_COUNT];
+
+// Rolling window statistics per stage
+static uint32_t window_min[PROFILE_STAGE_COUNT];
+static uint32_t window_max[PROFILE_STAGE_COUNT];
+static uint32_t window_sum[PROFILE_STAGE_COUNT];
+static int window_frames = 0;
+
+// Frame time shown by the overlay, from the last complete window
+static uint32_t shown_avg = 0;
+static uint32_t shown_max = 0;
+
+// Raw timestamp: CP0 Count ticks on the SF2000, microseconds on the host.
+// Both wrap at 2^32 (Count after about 9.4 seconds), so differences of
+// raw values stay valid; convert only the difference with ticks_to_us().
+static uint32_t profile_now(void) {
+#ifdef SF2000
+    uint32_t count;
+    __asm__ volatile("mfc0 %0, $9" : "=r"(count));
+    return count;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000);
+#endif
+}
+
+static uint32_t ticks_to_us(uint32_t ticks) {
+#ifdef SF2000
+    return ticks / PROFILE_COUNT_MHZ;
+#else
+    return ticks;
+#endif
+}
+
+static void reset_window(void) {
+    for (int i = 0; i < PROFILE_STAGE_COUNT; i++) {
+        window_min[i] = UINT32_MAX;
+        window_max[i] = 0;
+        window_sum[i] = 0;
+    }
+    window_frames = 0;
+}
+
+void profile_set_enabled(int enabled) {
+    if (enabled && !profile_enabled) {
+        memset(frame_totals, 0, sizeof(frame_totals));
+        reset_window();
+        shown_avg = 0;
+        shown_max = 0;
+    }
+    profile_enabled = enabled;
+}
+
+int profile_is_enabled(void) {
+    return profile_enabled;
+}
+
+uint32_t profile_begin(void) {
+    return profile_enabled ? profile_now() : 0;
+}
+
+void profile_end(ProfileStage stage, uint32_t start) {
+    if (!profile_enabled) return;
+    frame_totals[stage] += ticks_to_us(profile_now() - start);
+}
+
+// Append one line with every stage's min/avg/max in microseconds
+static void log_window(void) {
+    FILE *fp = fopen(PROFILE_LOG_FILE, "a");
+    if (!fp) return;
+
+    for (int i = 0; i < PROFILE_STAGE_COUNT; i++) {
+        fprintf(fp, "%s%s %u/%u/%u", i ? "  " : "", stage_names[i],
+                (unsigned)window_min[i], (unsigned)(window_sum[i] / window_frames), (unsigned)window_max[i]);
+    }
+    fprintf(fp, "\n");
+    fclose(fp);
+}
+
+void profile_frame_done(void) {
+    if (!profile_enabled) return;
+
+    for (int i = 0; i < PROFILE_STAGE_COUNT; i++) {
+        uint32_t t = frame_totals[i];
+        if (t < window_min[i]) window_min[i] = t;
+        if (t > window_max[i]) window_max[i] = t;
+        window_sum[i] += t;
+        frame_totals[i] = 0;
+    }
+
+    if (++window_frames >= PROFILE_WINDOW_FRAMES) {
+        shown_avg = window_sum[PROFILE_FRAME] / window_frames;
+        shown_max = window_max[PROFILE_FRAME];
+        log_window();
+        reset_window();
+    }
+}
+
+void profile_draw_overlay(uint16_t *framebuffer) {
+    if (!profile_enabled || !framebuffer) return;
+
+    // Fixed-size pill so a shorter reading fully covers the previous one
+    int width = 104;
+    int x = (SCREEN_WIDTH - width) / 2;
+    int y = 8;
+    char text[32];
+    snprintf(text, sizeof(text), "%u.%u/%u.%uMS",
+             (unsigned)(shown_avg / 1000), (unsigned)(shown_avg % 1000 / 100),
+             (unsigned)(shown_max / 1000), (unsigned)(shown_max % 1000 / 100));
+
+    render_rounded_rect(framebuffer, x, y - 2, width, 20, 10, COLOR_LEGEND_BG);
+    font_draw_text(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, x + (width - font_measure_text(text)) / 2, y,
+                   text, COLOR_LEGEND);
+}
@@ -0,0 +1,39 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdint.h>
+
+#define PROFILE_LOG_FILE "/mnt/sda1/frogui/profile.log"
+#define PROFILE_WINDOW_FRAMES 60 // Frames per min/avg/max window (1 second at 60fps)
+
+// Timed stages. Stages nest: input includes the redraw it triggers, which
+// in turn includes scan, thumbnail and text time.
+typedef enum {
+    PROFILE_FRAME,    // Whole retro_run()
+    PROFILE_INPUT,    // handle_input()
+    PROFILE_SCAN,     // scan_directory()
+    PROFILE_SORT,     // Sorting the scanned entries
+    PROFILE_THUMB,    // load_current_thumbnail()
+    PROFILE_TEXT,     // font_draw_text()
+    PROFILE_BLIT,     // video_cb()
+    PROFILE_AUDIO,    // audio_run()
+    PROFILE_STAGE_COUNT
+} ProfileStage;
+
+// Enable or disable timing, the overlay and the log (frogui_show_frametime)
+void profile_set_enabled(int enabled);
+int profile_is_enabled(void);
+
+// Scoped timer: keep the raw timestamp from profile_begin() and pass it to
+// profile_end() when the stage finishes. Both are no-ops while disabled.
+uint32_t profile_begin(void);
+void profile_end(ProfileStage stage, uint32_t start);
+
+// Close the current frame: fold per-stage totals into the rolling window and
+// log the window's min/avg/max when it is full
+void profile_frame_done(void);
+
+// Draw the frame time overlay (average/max of the last window)
+void profile_draw_overlay(uint16_t *framebuffer);
+
+#endif // PROFILE_H
@@ -1,118 +1,418 @@
 #include "recent_games.h"
+#include "vfs.h"
+#include "journal.h"
 #include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
-// Recent games state
-static RecentGame recent_games[MAX_RECENT_GAMES];
-static int recent_count = 0;
+// Longest line in the text history or journal
+#define HISTORY_LINE_SIZE 1024
 
-void recent_games_init(void) {
-    recent_count = 0;
-    recent_games_load();
+#define HISTORY_MAGIC "FPH1"
+
+// Snapshot layout: the header, count records, then pool_size bytes of
+// strings. Native byte order, the file never leaves the device.
+typedef struct {
+    char magic[4];
+    uint32_t count;
+    uint32_t pool_size;
+    uint32_t serial;  // Last launch serial included in the snapshot
+} HistoryHeader;
+
+// A game's strings live in the pool and are referenced by offset
+typedef struct {
+    uint32_t core_name;
+    uint32_t game_name;
+    uint32_t full_path;
+    uint32_t launch_count;
+    uint32_t last_serial;  // Orders launches even without a working clock
+    uint32_t last_time;    // time() of the last launch
+} HistoryRecord;
+
+// History state, records in the order games were first launched
+static HistoryRecord *games = NULL;
+static uint32_t *game_keys = NULL;  // history_key(full_path, game_name)
+static int game_count = 0;
+static int game_capacity = 0;
+
+static char *pool = NULL;
+static uint32_t pool_used = 0;
+static uint32_t pool_capacity = 0;
+
+// Every launch gets the next serial. Journal records at or below the
+// snapshot's serial are already in the snapshot and skipped on replay.
+static uint32_t launch_serial = 0;
+static uint32_t snapshot_serial = 0;
+
+// Open addressing index over (full_path, game_name). Slots hold a game
+// index + 1, 0 is empty. The table is twice the record capacity.
+static int *history_hash = NULL;
+static int hash_size = 0;
+
+// Cached orderings, rebuilt on first use after the history changes
+static int *orders[HISTORY_VIEW_COUNT];
+static bool order_valid[HISTORY_VIEW_COUNT];
+
+static const char *view_names[HISTORY_VIEW_COUNT] = { "RECENTLY PLAYED", "MOST PLAYED" };
+
+// Journal records from before launch serials, replayed as new launches
+static bool legacy_records = false;
+
+// Records in the journal, so it can be folded back once it grows long
+static int journal_records = 0;
+
+static const char *pool_string(uint32_t offset) {
+    return pool + offset;
 }
 
-void recent_games_load(void) {
-    FILE *fp = fopen(HISTORY_FILE, "r");
-    if (!fp) {
-        recent_count = 0;
-        return;
-    }
-    
-    recent_count = 0;
-    char line[512];
-    
-    while (fgets(line, sizeof(line), fp) && recent_count < MAX_RECENT_GAMES) {
+// FNV-1a over "directory/game_name"
+static uint32_t history_key(const char *directory, const char *game_name) {
+    uint32_t hash = 2166136261u;
+    for (const char *p = directory; *p; p++) hash = (hash ^ (unsigned char)*p) * 16777619u;
+    hash = (hash ^ '/') * 16777619u;
+    for (const char *p = game_name; *p; p++) hash = (hash ^ (unsigned char)*p) * 16777619u;
+    return hash;
+}
+
+static void index_game(int index) {
+    int slot = game_keys[index] & (hash_size - 1);
+    while (history_hash[slot]) slot = (slot + 1) & (hash_size - 1);
+    history_hash[slot] = index + 1;
+}
+
+static void rebuild_index(void) {
+    if (history_hash) memset(history_hash, 0, hash_size * sizeof(int));
+    for (int i = 0; i < game_count; i++) {
+        index_game(i);
+    }
+    memset(order_valid, 0, sizeof(order_valid));
+}
+
+// Grow the records, index and orders together to hold at least count games
+static bool reserve_games(int count) {
+    if (count <= game_capacity) return true;
+
+    // A power of two, so the index can mask instead of divide
+    int capacity = game_capacity ? game_capacity : 64;
+    while (capacity < count) capacity *= 2;
+
+    HistoryRecord *grown = (HistoryRecord*)realloc(games, capacity * sizeof(HistoryRecord));
+    if (!grown) return false;
+    games = grown;
+
+    uint32_t *keys = (uint32_t*)realloc(game_keys, capacity * sizeof(uint32_t));
+    if (!keys) return false;
+    game_keys = keys;
+
+    for (int i = 0; i < HISTORY_VIEW_COUNT; i++) {
+        int *order = (int*)realloc(orders[i], capacity * sizeof(int));
+        if (!order) return false;
+        orders[i] = order;
+    }
+
+    int *hash = (int*)realloc(history_hash, capacity * 2 * sizeof(int));
+    if (!hash) return false;
+    history_hash = hash;
+    hash_size = capacity * 2;
+    game_capacity = capacity;
+
+    rebuild_index();
+    return true;
+}
+
+static bool reserve_pool(uint32_t size) {
+    if (size <= pool_capacity) return true;
+
+    uint32_t capacity = pool_capacity ? pool_capacity : 4096;
+    while (size > capacity) capacity *= 2;
+    char *grown = (char*)realloc(pool, capacity);
+    if (!grown) return false;
+    pool = grown;
+    pool_capacity = capacity;
+    return true;
+}
+
+// Copy a string into the pool, returning its offset
+static bool pool_add(const char *text, uint32_t *offset) {
+    uint32_t length = strlen(text) + 1;
+    if (!reserve_pool(pool_used + length)) return false;
+
+    memcpy(pool + pool_used, text, length);
+    *offset = pool_used;
+    pool_used += length;
+    return true;
+}
+
+static void reset_history(void) {
+    game_count = 0;
+    pool_used = 0;
+    launch_serial = 0;
+    snapshot_serial = 0;
+    legacy_records = false;
+    rebuild_index();
+}
+
+// Add a game that was never launched, returning its index or -1
+static int add_game(const char *core_name, const char *game_name, const char *full_path) {
+    if (!reserve_games(game_count + 1)) {
+        return -1;
+    }
+
+    HistoryRecord *game = &games[game_count];
+    uint32_t saved_used = pool_used;
+    if (!pool_add(core_name, &game->core_name) ||
+        !pool_add(game_name, &game->game_name) ||
+        !pool_add(full_path, &game->full_path)) {
+        pool_used = saved_used;
+        return -1;
+    }
+    game->launch_count = 0;
+    game->last_serial = 0;
+    game->last_time = 0;
+    game_keys[game_count] = history_key(full_path, game_name);
+
+    index_game(game_count);
+    return game_count++;
+}
+
+static void count_launch(const char *core_name, const char *game_name, const char *full_path,
+                         uint32_t serial, uint32_t launch_time) {
+    int index = recent_games_find(full_path, game_name);
+    if (index < 0) index = add_game(core_name, game_name, full_path);
+    if (index < 0) return;
+
+    games[index].launch_count++;
+    games[index].last_serial = serial;
+    games[index].last_time = launch_time;
+    if (serial > launch_serial) launch_serial = serial;
+    memset(order_valid, 0, sizeof(order_valid));
+}
+
+// Read the binary snapshot. Returns false if there is none or it's damaged.
+static bool load_snapshot(void) {
+    FILE *fp = journal_open_snapshot(HISTORY_FILE, HISTORY_TEMP_FILE);
+    if (!fp) return false;
+
+    vfs_fseek(fp, 0, SEEK_END);
+    long size = vfs_ftell(fp);
+    vfs_fseek(fp, 0, SEEK_SET);
+
+    // The sizes in the header must add up to the file size before anything is allocated
+    HistoryHeader header;
+    bool ok = vfs_fread(&header, sizeof(header), 1, fp) == 1 &&
+              memcmp(header.magic, HISTORY_MAGIC, 4) == 0 &&
+              header.count <= (uint32_t)size / sizeof(HistoryRecord) &&
+              sizeof(header) + (long)header.count * sizeof(HistoryRecord) + header.pool_size == (unsigned long)size &&
+              reserve_games(header.count) && reserve_pool(header.pool_size) &&
+              vfs_fread(games, sizeof(HistoryRecord), header.count, fp) == header.count &&
+              vfs_fread(pool, 1, header.pool_size, fp) == header.pool_size;
+    vfs_fclose(fp);
+
+    // Every string must start inside the pool, and the pool must end in a terminator
+    ok = ok && (header.pool_size == 0 ? header.count == 0 : pool[header.pool_size - 1] == '\0');
+    for (uint32_t i = 0; ok && i < header.count; i++) {
+        ok = games[i].core_name < header.pool_size && games[i].game_name < header.pool_size &&
+             games[i].full_path < header.pool_size;
+    }
+    if (!ok) return false;
+
+    game_count = header.count;
+    pool_used = header.pool_size;
+    launch_serial = snapshot_serial = header.serial;
+    for (int i = 0; i < game_count; i++) {
+        game_keys[i] = history_key(pool_string(games[i].full_path), pool_string(games[i].game_name));
+    }
+    rebuild_index();
+    return true;
+}
+
+// Import the text history of older versions: "core_name|game_name|full_path"
+// lines, most recent first. Returns true if there was one.
+static bool import_text_history(void) {
+    FILE *fp = vfs_fopen(HISTORY_TEXT_FILE, "r");
+    if (!fp) return false;
+
+    char line[HISTORY_LINE_SIZE];
+    while (vfs_fgets(line, sizeof(line), fp)) {
         // Remove newline
         line[strcspn(line, "\r\n")] = 0;
-        
-        // Parse line: "core_name|game_name|full_path"
+
         char *separator1 = strchr(line, '|');
-        if (separator1) {
-            *separator1 = '\0';
-            char *separator2 = strchr(separator1 + 1, '|');
-            if (separator2) {
-                *separator2 = '\0';
-                strncpy(recent_games[recent_count].core_name, line, sizeof(recent_games[recent_count].core_name) - 1);
-                strncpy(recent_games[recent_count].game_name, separator1 + 1, sizeof(recent_games[recent_count].game_name) - 1);
-                strncpy(recent_games[recent_count].full_path, separator2 + 1, sizeof(recent_games[recent_count].full_path) - 1);
-                
-                // Create display name
-                snprintf(recent_games[recent_count].display_name, sizeof(recent_games[recent_count].display_name),
-                        "%s (%s)", recent_games[recent_count].game_name, recent_games[recent_count].core_name);
-                
-                recent_count++;
-            } else {
-                // Old format fallback: "core_name|game_name" 
-                strncpy(recent_games[recent_count].core_name, line, sizeof(recent_games[recent_count].core_name) - 1);
-                strncpy(recent_games[recent_count].game_name, separator1 + 1, sizeof(recent_games[recent_count].game_name) - 1);
-                recent_games[recent_count].full_path[0] = '\0'; // No path available
-                
-                snprintf(recent_games[recent_count].display_name, sizeof(recent_games[recent_count].display_name),
-                        "%s (%s)", recent_games[recent_count].game_name, recent_games[recent_count].core_name);
-                
-                recent_count++;
-            }
+        if (!separator1) continue;
+        *separator1 = '\0';
+
+        // Old format fallback: "core_name|game_name" has no path
+        char *separator2 = strchr(separator1 + 1, '|');
+        if (separator2) *separator2 = '\0';
+
+        count_launch(line, separator1 + 1, separator2 ? separator2 + 1 : "", launch_serial + 1, 0);
+    }
+    vfs_fclose(fp);
+
+    // Lines came most recent first, flip the serials
+    for (int i = 0; i < game_count; i++) {
+        games[i].last_serial = launch_serial + 1 - games[i].last_serial;
+    }
+    return true;
+}
+
+// Journal records are launches: "serial|time|core_name|game_name|full_path"
+static void apply_record(char *record) {
+    char *fields[5];
+    int count = 0;
+    fields[count++] = record;
+    for (char *p = record; *p && count < 5; p++) {
+        if (*p == '|') {
+            *p = '\0';
+            fields[count++] = p + 1;
         }
     }
-    
-    fclose(fp);
+
+    char *end;
+    unsigned long serial = strtoul(fields[0], &end, 10);
+    if (count == 5 && *end == '\0') {
+        if (serial > snapshot_serial) {
+            count_launch(fields[2], fields[3], fields[4], serial, strtoul(fields[1], NULL, 10));
+        }
+    } else if (count == 3) {
+        // "core_name|game_name|full_path" from before launch serials
+        count_launch(fields[0], fields[1], fields[2], launch_serial + 1, 0);
+        legacy_records = true;
+    }
+}
+
+void recent_games_init(void) {
+    recent_games_load();
+}
+
+void recent_games_load(void) {
+    reset_history();
+
+    bool imported = false;
+    if (!load_snapshot()) {
+        reset_history();
+        imported = import_text_history();
+    }
+
+    // Fold a long journal back into the snapshot
+    journal_records = journal_replay(HISTORY_JOURNAL, apply_record);
+    if (imported || legacy_records) {
+        recent_games_save();
+    } else {
+        recent_games_compact();
+    }
+}
+
+void recent_games_compact(void) {
+    if (journal_records >= JOURNAL_COMPACT_RECORDS) recent_games_save();
 }
 
 void recent_games_save(void) {
-    FILE *fp = fopen(HISTORY_FILE, "w");
+    FILE *fp = vfs_fopen(HISTORY_TEMP_FILE, "wb");
     if (!fp) return;
-    
-    for (int i = 0; i < recent_count; i++) {
-        fprintf(fp, "%s|%s|%s\n", recent_games[i].core_name, recent_games[i].game_name, recent_games[i].full_path);
+
+    HistoryHeader header;
+    memcpy(header.magic, HISTORY_MAGIC, 4);
+    header.count = game_count;
+    header.pool_size = pool_used;
+    header.serial = launch_serial;
+
+    bool ok = vfs_fwrite(&header, sizeof(header), 1, fp) == 1 &&
+              vfs_fwrite(games, sizeof(HistoryRecord), game_count, fp) == (size_t)game_count &&
+              vfs_fwrite(pool, 1, pool_used, fp) == pool_used;
+
+    if (vfs_fclose(fp) != 0) ok = false;
+    if (ok && journal_commit(HISTORY_FILE, HISTORY_TEMP_FILE, HISTORY_JOURNAL)) {
+        snapshot_serial = launch_serial;
+        legacy_records = false;
+        journal_records = 0;
+    } else if (!ok) {
+        vfs_remove(HISTORY_TEMP_FILE);
     }
-    
-    fclose(fp);
 }
 
 void recent_games_add(const char *core_name, const char *game_name, const char *full_path) {
-    // Check if game already exists
-    int existing_index = -1;
-    for (int i = 0; i < recent_count; i++) {
-        if (strcmp(recent_games[i].core_name, core_name) == 0 && 
-            strcmp(recent_games[i].game_name, game_name) == 0) {
-            existing_index = i;
-            break;
-        }
-    }
-    
-    // If exists, move to top
-    if (existing_index >= 0) {
-        RecentGame temp = recent_games[existing_index];
-        for (int i = existing_index; i > 0; i--) {
-            recent_games[i] = recent_games[i - 1];
-        }
-        recent_games[0] = temp;
+    uint32_t serial = launch_serial + 1;
+    uint32_t launch_time = (uint32_t)time(NULL);
+    count_launch(core_name, game_name, full_path, serial, launch_time);
+
+    // This runs right before a game launches, so only append to the journal
+    char record[HISTORY_LINE_SIZE];
+    snprintf(record, sizeof(record), "%u|%u|%s|%s|%s", (unsigned)serial, (unsigned)launch_time,
+             core_name, game_name, full_path);
+    if (journal_append(HISTORY_JOURNAL, record)) {
+        journal_records++;
     } else {
-        // Add new game at top
-        if (recent_count < MAX_RECENT_GAMES) {
-            recent_count++;
-        }
-        
-        // Shift all games down
-        for (int i = recent_count - 1; i > 0; i--) {
-            recent_games[i] = recent_games[i - 1];
+        recent_games_save();
+    }
+}
+
+int recent_games_get_count(void) {
+    return game_count;
+}
+
+int recent_games_find(const char *full_path, const char *game_name) {
+    if (game_count == 0) return -1;
+
+    uint32_t key = history_key(full_path, game_name);
+    int slot = key & (hash_size - 1);
+
+    while (history_hash[slot]) {
+        int i = history_hash[slot] - 1;
+        if (game_keys[i] == key &&
+            strcmp(pool_string(games[i].full_path), full_path) == 0 &&
+            strcmp(pool_string(games[i].game_name), game_name) == 0) {
+            return i;
         }
-        
-        // Add new game at top
-        strncpy(recent_games[0].core_name, core_name, sizeof(recent_games[0].core_name) - 1);
-        strncpy(recent_games[0].game_name, game_name, sizeof(recent_games[0].game_name) - 1);
-        strncpy(recent_games[0].full_path, full_path, sizeof(recent_games[0].full_path) - 1);
-        snprintf(recent_games[0].display_name, sizeof(recent_games[0].display_name),
-                "%s (%s)", game_name, core_name);
+        slot = (slot + 1) & (hash_size - 1);
     }
-    
-    recent_games_save();
+    return -1;
 }
 
-const RecentGame* recent_games_get_list(void) {
-    return recent_games;
+const char *recent_games_get_core_name(int index) {
+    return pool_string(games[index].core_name);
 }
 
-int recent_games_get_count(void) {
-    return recent_count;
-}
\ No newline at end of file
+const char *recent_games_get_game_name(int index) {
+    return pool_string(games[index].game_name);
+}
+
+const char *recent_games_get_full_path(int index) {
+    return pool_string(games[index].full_path);
+}
+
+uint32_t recent_games_get_launch_count(int index) {
+    return games[index].launch_count;
+}
+
+static int compare_by_recent(const void *a, const void *b) {
+    uint32_t serial_a = games[*(const int*)a].last_serial;
+    uint32_t serial_b = games[*(const int*)b].last_serial;
+    return serial_a < serial_b ? 1 : serial_a > serial_b ? -1 : 0;
+}
+
+static int compare_by_launches(const void *a, const void *b) {
+    uint32_t count_a = games[*(const int*)a].launch_count;
+    uint32_t count_b = games[*(const int*)b].launch_count;
+    if (count_a != count_b) return count_a < count_b ? 1 : -1;
+    return compare_by_recent(a, b);
+}
+
+const int *recent_games_get_order(HistoryView view) {
+    int *order = orders[view];
+    if (!order_valid[view] && game_count > 0) {
+        for (int i = 0; i < game_count; i++) {
+            order[i] = i;
+        }
+        qsort(order, game_count, sizeof(int),
+              view == HISTORY_VIEW_RECENT ? compare_by_recent : compare_by_launches);
+        order_valid[view] = true;
+    }
+    return order;
+}
+
+const char *recent_games_view_name(HistoryView view) {
+    return view_names[view];
+}
@@ -1,33 +1,56 @@
 #ifndef RECENT_GAMES_H
 #define RECENT_GAMES_H
 
-#define MAX_RECENT_GAMES 10
-#define HISTORY_FILE "/mnt/sda1/frogui/game_history.txt"
+#include <stdint.h>
 
-// Recent games structure
-typedef struct {
-    char core_name[256];
-    char game_name[256];
-    char display_name[256];
-    char full_path[512];  // Full path for thumbnail lookup
-} RecentGame;
+// Play history: one record per game ever launched, with its launch count
+// and when it was last launched. Kept in a binary snapshot plus a journal
+// of launches since (see journal.h).
+#define HISTORY_FILE "/mnt/sda1/frogui/play_history.bin"
+#define HISTORY_TEMP_FILE "/mnt/sda1/frogui/play_history.bin.tmp"
+#define HISTORY_JOURNAL "/mnt/sda1/frogui/game_history.log"
+
+// Text history of older versions, imported once when there's no snapshot
+#define HISTORY_TEXT_FILE "/mnt/sda1/frogui/game_history.txt"
+
+// Orders the history can be shown in
+typedef enum {
+    HISTORY_VIEW_RECENT,       // Last launched first
+    HISTORY_VIEW_MOST_PLAYED,  // Most launches first
+    HISTORY_VIEW_COUNT
+} HistoryView;
 
 // Initialize recent games system
 void recent_games_init(void);
 
-// Load recent games from file
+// Load the history snapshot and replay its journal
 void recent_games_load(void);
 
-// Save recent games to file  
+// Write the whole history snapshot, which also empties the journal
 void recent_games_save(void);
 
-// Add game to recent history (moves to top if already exists)
-void recent_games_add(const char *core_name, const char *game_name, const char *full_path);
+// Write a new snapshot if the journal has grown past JOURNAL_COMPACT_RECORDS
+// since the last one. Called between user actions, never on the launch path.
+void recent_games_compact(void);
 
-// Get recent games list
-const RecentGame* recent_games_get_list(void);
+// Count a launch of a game. Only appends one record to the journal.
+void recent_games_add(const char *core_name, const char *game_name, const char *full_path);
 
-// Get count of recent games
+// Number of games in the history
 int recent_games_get_count(void);
 
+// Index of a game by folder and file name, or -1. One hash lookup.
+int recent_games_find(const char *full_path, const char *game_name);
+
+// Fields of a game. Indexes stay valid until the history changes.
+const char *recent_games_get_core_name(int index);
+const char *recent_games_get_game_name(int index);
+const char *recent_games_get_full_path(int index);
+uint32_t recent_games_get_launch_count(int index);
+
+// Game indexes in the given order, recent_games_get_count() of them. The
+// array is cached until the history changes.
+const int *recent_games_get_order(HistoryView view);
+const char *recent_games_view_name(HistoryView view);
+
 #endif // RECENT_GAMES_H
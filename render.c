@@ -1,12 +1,12 @@
 #include "render.h"
 #include "theme.h"
 #include "font.h"
+#include "vfs.h"
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <math.h>
 #include <unistd.h>
-#include <dirent.h>
 
 #ifndef min
 #define min(a, b) ((a) < (b) ? (a) : (b))
@@ -27,25 +27,25 @@ void render_clear_screen(uint16_t *framebuffer) {
     }
 }
 
-void render_fill_rect(uint16_t *framebuffer, int x, int y, int width, int height, uint16_t color) {
-    if (!framebuffer) return;
-    
-    for (int py = y; py < y + height && py < SCREEN_HEIGHT; py++) {
-        for (int px = x; px < x + width && px < SCREEN_WIDTH; px++) {
+// Fill a rectangle in a buffer of the given dimensions, clipped to it
+static void fill_rect_in(uint16_t *buffer, int buffer_width, int buffer_height,
+                         int x, int y, int width, int height, uint16_t color) {
+    for (int py = y; py < y + height && py < buffer_height; py++) {
+        for (int px = x; px < x + width && px < buffer_width; px++) {
             if (px >= 0 && py >= 0) {
-                framebuffer[py * SCREEN_WIDTH + px] = color;
+                buffer[py * buffer_width + px] = color;
             }
         }
     }
 }
 
-void render_rounded_rect(uint16_t *framebuffer, int x, int y, int width, int height, int radius, uint16_t color) {
-    if (!framebuffer) return;
-    
+// Rounded rectangle in a buffer of the given dimensions, clipped to it
+static void rounded_rect_in(uint16_t *buffer, int buffer_width, int buffer_height,
+                            int x, int y, int width, int height, int radius, uint16_t color) {
     // Draw main body (excluding corners)
-    render_fill_rect(framebuffer, x + radius, y, width - 2 * radius, height, color);
-    render_fill_rect(framebuffer, x, y + radius, width, height - 2 * radius, color);
-    
+    fill_rect_in(buffer, buffer_width, buffer_height, x + radius, y, width - 2 * radius, height, color);
+    fill_rect_in(buffer, buffer_width, buffer_height, x, y + radius, width, height - 2 * radius, color);
+
     // Draw rounded corners using circle approximation
     for (int corner_y = 0; corner_y < radius; corner_y++) {
         for (int corner_x = 0; corner_x < radius; corner_x++) {
@@ -53,37 +53,192 @@ void render_rounded_rect(uint16_t *framebuffer, int x, int y, int width, int hei
             int dy = radius - corner_y;
             int dist_sq = dx * dx + dy * dy;
             int radius_sq = radius * radius;
-            
+
             if (dist_sq <= radius_sq) {
-                // Top-left corner
-                int px = x + corner_x;
-                int py = y + corner_y;
-                if (px >= 0 && px < SCREEN_WIDTH && py >= 0 && py < SCREEN_HEIGHT) {
-                    framebuffer[py * SCREEN_WIDTH + px] = color;
-                }
-                
-                // Top-right corner
-                px = x + width - 1 - corner_x;
-                py = y + corner_y;
-                if (px >= 0 && px < SCREEN_WIDTH && py >= 0 && py < SCREEN_HEIGHT) {
-                    framebuffer[py * SCREEN_WIDTH + px] = color;
-                }
-                
-                // Bottom-left corner
-                px = x + corner_x;
-                py = y + height - 1 - corner_y;
-                if (px >= 0 && px < SCREEN_WIDTH && py >= 0 && py < SCREEN_HEIGHT) {
-                    framebuffer[py * SCREEN_WIDTH + px] = color;
+                // Top-left, top-right, bottom-left, bottom-right
+                int xs[4] = { x + corner_x, x + width - 1 - corner_x, x + corner_x, x + width - 1 - corner_x };
+                int ys[4] = { y + corner_y, y + corner_y, y + height - 1 - corner_y, y + height - 1 - corner_y };
+                for (int i = 0; i < 4; i++) {
+                    if (xs[i] >= 0 && xs[i] < buffer_width && ys[i] >= 0 && ys[i] < buffer_height) {
+                        buffer[ys[i] * buffer_width + xs[i]] = color;
+                    }
                 }
-                
-                // Bottom-right corner
-                px = x + width - 1 - corner_x;
-                py = y + height - 1 - corner_y;
-                if (px >= 0 && px < SCREEN_WIDTH && py >= 0 && py < SCREEN_HEIGHT) {
-                    framebuffer[py * SCREEN_WIDTH + px] = color;
+            }
+        }
+    }
+}
+
+void render_fill_rect(uint16_t *framebuffer, int x, int y, int width, int height, uint16_t color) {
+    if (!framebuffer) return;
+
+    fill_rect_in(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, x, y, width, height, color);
+}
+
+void render_rounded_rect(uint16_t *framebuffer, int x, int y, int width, int height, int radius, uint16_t color) {
+    if (!framebuffer) return;
+
+    rounded_rect_in(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, x, y, width, height, radius, color);
+}
+
+// Label cache - static UI labels (legends, headers, hints) are rendered
+// once into an offscreen bitmap together with their pill and then blitted.
+// Only the pixels on each row's opaque span are copied, so rounded corners
+// keep whatever is underneath. Entries are keyed by text, geometry, colors
+// and font generation, so a theme or font change simply misses and rebuilds.
+#define LABEL_CACHE_SLOTS 8
+#define LABEL_TEXT_MAX 48
+#define NO_PILL (-1)
+
+typedef struct {
+    char text[LABEL_TEXT_MAX];
+    int font_generation;
+    int x, y, width, height;      // Bitmap rectangle on screen
+    int radius;                   // Pill corner radius, NO_PILL for bare text
+    int text_x, text_y;
+    uint16_t pill_color;
+    uint16_t text_color;
+    uint16_t under_color;         // Background assumed under bare text
+    uint16_t *pixels;
+    int16_t *span_start;          // First opaque column per row
+    int16_t *span_end;            // One past the last opaque column per row
+    unsigned int last_used;
+} CachedLabel;
+
+static CachedLabel label_cache[LABEL_CACHE_SLOTS];
+static unsigned int label_clock = 0;
+
+static int label_matches(const CachedLabel *l, int x, int y, int width, int height, int radius,
+                         uint16_t pill_color, int text_x, int text_y, const char *text,
+                         uint16_t text_color, uint16_t under_color) {
+    return l->pixels && l->font_generation == font_get_generation() &&
+           l->x == x && l->y == y && l->width == width && l->height == height &&
+           l->radius == radius && l->pill_color == pill_color &&
+           l->text_x == text_x && l->text_y == text_y &&
+           l->text_color == text_color && l->under_color == under_color &&
+           strcmp(l->text, text) == 0;
+}
+
+static int build_label(CachedLabel *l, int x, int y, int width, int height, int radius,
+                       uint16_t pill_color, int text_x, int text_y, const char *text,
+                       uint16_t text_color, uint16_t under_color) {
+    free(l->pixels);
+    free(l->span_start);
+    free(l->span_end);
+    l->pixels = (uint16_t*)malloc(width * height * sizeof(uint16_t));
+    l->span_start = (int16_t*)malloc(height * sizeof(int16_t));
+    l->span_end = (int16_t*)malloc(height * sizeof(int16_t));
+    if (!l->pixels || !l->span_start || !l->span_end) {
+        free(l->pixels);
+        free(l->span_start);
+        free(l->span_end);
+        l->pixels = NULL;
+        l->span_start = NULL;
+        l->span_end = NULL;
+        return 0;
+    }
+
+    for (int i = 0; i < width * height; i++) {
+        l->pixels[i] = under_color;
+    }
+
+    // Find the pill's own spans by drawing it in a colour that cannot be
+    // mistaken for the background, then draw it for real
+    if (radius != NO_PILL) {
+        rounded_rect_in(l->pixels, width, height, 0, 0, width, height, radius, (uint16_t)~under_color);
+    }
+    for (int row = 0; row < height; row++) {
+        const uint16_t *p = l->pixels + row * width;
+        int start = 0, end = width;
+        while (start < width && p[start] == under_color) start++;
+        while (end > start && p[end - 1] == under_color) end--;
+        l->span_start[row] = start;
+        l->span_end[row] = end;
+    }
+    if (radius != NO_PILL) {
+        rounded_rect_in(l->pixels, width, height, 0, 0, width, height, radius, pill_color);
+    }
+
+    font_draw_text(l->pixels, width, height, text_x - x, text_y - y, text, text_color);
+
+    // Widen the spans to any text pixels outside the pill
+    for (int row = 0; row < height; row++) {
+        const uint16_t *p = l->pixels + row * width;
+        for (int col = 0; col < width; col++) {
+            if (p[col] != under_color) {
+                if (col < l->span_start[row]) l->span_start[row] = col;
+                if (col + 1 > l->span_end[row]) l->span_end[row] = col + 1;
+            }
+        }
+    }
+
+    strcpy(l->text, text);
+    l->font_generation = font_get_generation();
+    l->x = x;
+    l->y = y;
+    l->width = width;
+    l->height = height;
+    l->radius = radius;
+    l->pill_color = pill_color;
+    l->text_x = text_x;
+    l->text_y = text_y;
+    l->text_color = text_color;
+    l->under_color = under_color;
+    return 1;
+}
+
+// Draw a label from the cache, rendering it on a miss. Labels whose text is
+// too long to key fall back to drawing directly.
+static void render_cached_label(uint16_t *framebuffer, int x, int y, int width, int height, int radius,
+                                uint16_t pill_color, int text_x, int text_y, const char *text,
+                                uint16_t text_color, uint16_t under_color) {
+    CachedLabel *l = NULL;
+
+    if (strlen(text) < LABEL_TEXT_MAX && width > 0 && height > 0) {
+        for (int i = 0; i < LABEL_CACHE_SLOTS; i++) {
+            if (label_matches(&label_cache[i], x, y, width, height, radius, pill_color,
+                              text_x, text_y, text, text_color, under_color)) {
+                l = &label_cache[i];
+                break;
+            }
+        }
+
+        if (!l) {
+            // Replace the least recently used entry
+            l = &label_cache[0];
+            for (int i = 1; i < LABEL_CACHE_SLOTS; i++) {
+                if (label_cache[i].last_used < l->last_used) {
+                    l = &label_cache[i];
                 }
             }
+            if (!build_label(l, x, y, width, height, radius, pill_color,
+                             text_x, text_y, text, text_color, under_color)) {
+                l = NULL;
+            }
+        }
+    }
+
+    if (!l) {
+        if (radius != NO_PILL) {
+            render_rounded_rect(framebuffer, x, y, width, height, radius, pill_color);
         }
+        font_draw_text(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, text_x, text_y, text, text_color);
+        return;
+    }
+
+    l->last_used = ++label_clock;
+
+    for (int row = 0; row < height; row++) {
+        int py = y + row;
+        if (py < 0 || py >= SCREEN_HEIGHT) continue;
+
+        int start = l->span_start[row];
+        int end = l->span_end[row];
+        if (x + start < 0) start = -x;
+        if (x + end > SCREEN_WIDTH) end = SCREEN_WIDTH - x;
+        if (start >= end) continue;
+
+        memcpy(framebuffer + py * SCREEN_WIDTH + x + start, l->pixels + row * width + start,
+               (end - start) * sizeof(uint16_t));
     }
 }
 
@@ -109,11 +264,34 @@ void render_text_pillbox(uint16_t *framebuffer, int x, int y, const char *text,
     font_draw_text(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, x, y, text, text_color);
 }
 
+void render_label_pillbox(uint16_t *framebuffer, int x, int y, const char *text,
+                          uint16_t bg_color, uint16_t text_color, int padding) {
+    if (!framebuffer || !text) return;
+
+    // Same geometry as render_text_pillbox()
+    int left_padding = 6;
+    int pillbox_width = font_measure_text(text) + left_padding + padding;
+    int pillbox_height = FONT_CHAR_HEIGHT + padding;
+
+    render_cached_label(framebuffer, x - left_padding, y - (padding / 2), pillbox_width, pillbox_height, 8,
+                        bg_color, x, y, text, text_color, COLOR_BG);
+}
+
 void render_header(uint16_t *framebuffer, const char *title) {
     if (!framebuffer || !title) return;
     
-    // Draw folder/section name in header area
-    font_draw_text(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, PADDING, 10, title, COLOR_HEADER);
+    // Draw folder/section name in header area. The header always sits on
+    // the plain background, so the cached bitmap can assume it underneath.
+    int header_y = 10;
+    render_cached_label(framebuffer, PADDING - 4, header_y - 4, font_measure_text(title) + 8, HEADER_HEIGHT,
+                        NO_PILL, 0, PADDING, header_y, title, COLOR_HEADER, COLOR_BG);
+}
+
+void render_legend_pill(uint16_t *framebuffer, int x, int y, const char *text) {
+    if (!framebuffer || !text) return;
+
+    render_cached_label(framebuffer, x - 4, y - 2, font_measure_text(text) + 8, 20, 10,
+                        COLOR_LEGEND_BG, x, y, text, COLOR_LEGEND, COLOR_BG);
 }
 
 void render_legend(uint16_t *framebuffer, int x_button_mode) {
@@ -126,17 +304,154 @@ void render_legend(uint16_t *framebuffer, int x_button_mode) {
     const char *settings_legend = " SEL - SETTINGS ";
     int settings_width = font_measure_text(settings_legend);
     int settings_x = SCREEN_WIDTH - settings_width - 12;
-    render_rounded_rect(framebuffer, settings_x - 4, legend_y - 2, settings_width + 8, 20, 10, COLOR_LEGEND_BG);
-    font_draw_text(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, settings_x, legend_y, settings_legend, COLOR_LEGEND);
+    render_legend_pill(framebuffer, settings_x, legend_y, settings_legend);
 
     // Draw X button legend to the left of settings
     if (x_button_mode != LEGEND_X_NONE) {
         const char *x_legend = (x_button_mode == LEGEND_X_REMOVE) ? " X - REMOVE " : " X - FAVOURITE ";
         int x_width = font_measure_text(x_legend);
         int x_x = settings_x - x_width - spacing - 12;
-        render_rounded_rect(framebuffer, x_x - 4, legend_y - 2, x_width + 8, 20, 10, COLOR_LEGEND_BG);
-        font_draw_text(framebuffer, SCREEN_WIDTH, SCREEN_HEIGHT, x_x, legend_y, x_legend, COLOR_LEGEND);
+        render_legend_pill(framebuffer, x_x, legend_y, x_legend);
+    }
+}
+
+// Marquee for the selected item's name when it is too long to fit. The whole
+// name is rendered once into an offscreen strip on the selection pill's
+// colour; each frame a pixel window of the strip is copied into the pill, so
+// scrolling never re-rasterizes text or redraws anything else.
+#define MARQUEE_TOP 2       // Strip rows start this far above the text y
+#define MARQUEE_HEIGHT 21   // Rows inside the pill that are clear of its corners
+
+static struct {
+    int active;             // Window is on screen and may be animated
+    char text[256];
+    int font_generation;
+    uint16_t bg_color;
+    uint16_t text_color;
+    uint16_t *strip;
+    int strip_width;        // Full text width in pixels
+    int strip_capacity;     // Allocated strip width in pixels
+    int x, y;               // Text position of the window on screen
+    int window_width;
+    int offset;             // Current scroll position in pixels
+    int direction;
+    int pause;              // Frames left to hold before moving
+} marquee;
+
+// Render text into the strip unless it already holds it
+static int marquee_prepare(const char *text, uint16_t bg_color, uint16_t text_color) {
+    int width = font_measure_text(text);
+
+    if (marquee.strip && marquee.font_generation == font_get_generation() &&
+        marquee.bg_color == bg_color && marquee.text_color == text_color &&
+        strcmp(marquee.text, text) == 0) {
+        return 1;
+    }
+
+    if (width > marquee.strip_capacity) {
+        uint16_t *strip = (uint16_t*)realloc(marquee.strip, width * MARQUEE_HEIGHT * sizeof(uint16_t));
+        if (!strip) return 0;
+        marquee.strip = strip;
+        marquee.strip_capacity = width;
+    }
+
+    for (int i = 0; i < width * MARQUEE_HEIGHT; i++) {
+        marquee.strip[i] = bg_color;
+    }
+    font_draw_text(marquee.strip, width, MARQUEE_HEIGHT, 0, MARQUEE_TOP, text, text_color);
+
+    // A different name starts from the beginning
+    if (strcmp(marquee.text, text) != 0) {
+        render_marquee_reset();
+    }
+
+    snprintf(marquee.text, sizeof(marquee.text), "%s", text);
+    marquee.font_generation = font_get_generation();
+    marquee.bg_color = bg_color;
+    marquee.text_color = text_color;
+    marquee.strip_width = width;
+    return 1;
+}
+
+// Copy the window at the current offset into the framebuffer
+static void marquee_blit(uint16_t *framebuffer) {
+    int width = marquee.window_width;
+    if (marquee.x + width > SCREEN_WIDTH) width = SCREEN_WIDTH - marquee.x;
+
+    for (int row = 0; row < MARQUEE_HEIGHT; row++) {
+        int py = marquee.y - MARQUEE_TOP + row;
+        if (py < 0 || py >= SCREEN_HEIGHT) continue;
+        memcpy(framebuffer + py * SCREEN_WIDTH + marquee.x,
+               marquee.strip + row * marquee.strip_width + marquee.offset,
+               width * sizeof(uint16_t));
+    }
+}
+
+void render_marquee_reset(void) {
+    marquee.offset = 0;
+    marquee.direction = 1;
+    marquee.pause = SCROLL_DELAY_FRAMES;
+}
+
+void render_marquee_stop(void) {
+    marquee.active = 0;
+}
+
+void render_marquee_tick(uint16_t *framebuffer) {
+    if (!framebuffer || !marquee.active) return;
+
+    if (marquee.pause > 0) {
+        marquee.pause--;
+        return;
+    }
+
+    // Bounce between the start and the end of the name, pausing at each
+    int max_offset = marquee.strip_width - marquee.window_width;
+    marquee.offset += marquee.direction * SCROLL_PIXELS_PER_FRAME;
+    if (marquee.offset >= max_offset) {
+        marquee.offset = max_offset;
+        marquee.direction = -1;
+        marquee.pause = SCROLL_DELAY_FRAMES;
+    } else if (marquee.offset <= 0) {
+        marquee.offset = 0;
+        marquee.direction = 1;
+        marquee.pause = SCROLL_DELAY_FRAMES;
+    }
+
+    marquee_blit(framebuffer);
+}
+
+// Draw the selection pill for a name wider than the display limit and start
+// the marquee in it. Returns 0 if the name fits and should be drawn normally.
+static int render_marquee_item(uint16_t *framebuffer, int x, int y, const char *name) {
+    // The window shows as much as the old character limit did
+    char prefix[MAX_FILENAME_DISPLAY_LEN * 4 + 1];
+    int prefix_len = font_utf8_skip(name, MAX_FILENAME_DISPLAY_LEN) - name;
+    if (name[prefix_len] == '\0' || prefix_len >= (int)sizeof(prefix)) return 0;
+    memcpy(prefix, name, prefix_len);
+    prefix[prefix_len] = '\0';
+
+    int window_width = font_measure_text(prefix);
+    if (x + window_width > SCREEN_WIDTH) window_width = SCREEN_WIDTH - x;
+    if (!marquee_prepare(name, COLOR_SELECT_BG, COLOR_SELECT_TEXT) ||
+        marquee.strip_width <= window_width) {
+        return 0;
+    }
+
+    // Same pill geometry as render_text_pillbox() with padding 7
+    int padding = 7;
+    render_rounded_rect(framebuffer, x - 6, y - (padding / 2), window_width + 6 + padding,
+                        FONT_CHAR_HEIGHT + padding, 8, COLOR_SELECT_BG);
+
+    marquee.x = x;
+    marquee.y = y;
+    marquee.window_width = window_width;
+    if (marquee.offset > marquee.strip_width - window_width) {
+        render_marquee_reset();
     }
+    marquee.active = 1;
+    marquee_blit(framebuffer);
+    return 1;
 }
 
 void render_menu_item(uint16_t *framebuffer, int index, const char *name, int is_dir,
@@ -157,8 +472,10 @@ void render_menu_item(uint16_t *framebuffer, int index, const char *name, int is
     }
 
     if (is_selected) {
-        // Use unified pillbox rendering
-        render_text_pillbox(framebuffer, text_x, y, name, COLOR_SELECT_BG, COLOR_SELECT_TEXT, 7);
+        // Long names scroll inside the pill, others use unified pillbox rendering
+        if (!render_marquee_item(framebuffer, text_x, y, name)) {
+            render_text_pillbox(framebuffer, text_x, y, name, COLOR_SELECT_BG, COLOR_SELECT_TEXT, 7);
+        }
     } else {
         // Draw normal text
         uint16_t text_color = is_dir ? COLOR_FOLDER : COLOR_TEXT;
@@ -230,22 +547,23 @@ static uint16_t thumbnail_buffer[250 * 200]; // Max size: 250x200
 
 int load_raw_rgb565(const char *path, Thumbnail *thumb) {
     // Check if file exists
-    if (access(path, F_OK) != 0) {
+    if (vfs_access(path, F_OK) != 0) {
         return 0;
     }
     
-    FILE *fp = fopen(path, "rb");
+    FILE *fp = vfs_fopen(path, "rb");
     if (!fp) {
         return 0;
     }
     
-    fseek(fp, 0, SEEK_END);
-    long file_size = ftell(fp);
-    fseek(fp, 0, SEEK_SET);
+    vfs_fseek(fp, 0, SEEK_END);
+    long file_size = vfs_ftell(fp);
+    vfs_fseek(fp, 0, SEEK_SET);
     
     
     // Try common dimensions - including 160x160 for the resized images
-    int dimensions[][2] = {{64,64}, {128,128}, {160,160}, {200,200}, {250,200}, {200,250}};
+    // and the 160x128 / 160x200 boxes produced by convert_to_rgb565.py
+    int dimensions[][2] = {{64,64}, {128,128}, {160,160}, {160,128}, {160,200}, {200,200}, {250,200}, {200,250}};
     int num_dims = sizeof(dimensions) / sizeof(dimensions[0]);
     
     for (int i = 0; i < num_dims; i++) {
@@ -255,7 +573,7 @@ int load_raw_rgb565(const char *path, Thumbnail *thumb) {
             
             // Check if it fits in our static buffer
             if (w * h > sizeof(thumbnail_buffer) / 2) {
-                fclose(fp);
+                vfs_fclose(fp);
                 return 0;
             }
             
@@ -263,8 +581,8 @@ int load_raw_rgb565(const char *path, Thumbnail *thumb) {
             thumb->height = h;
             thumb->data = thumbnail_buffer; // Use static buffer
             
-            size_t read_bytes = fread(thumb->data, 1, file_size, fp);
-            fclose(fp);
+            size_t read_bytes = vfs_fread(thumb->data, 1, file_size, fp);
+            vfs_fclose(fp);
             
             if (read_bytes == file_size) {
                 return 1;
@@ -274,7 +592,7 @@ int load_raw_rgb565(const char *path, Thumbnail *thumb) {
         }
     }
     
-    fclose(fp);
+    vfs_fclose(fp);
     return 0;
 }
 
@@ -327,6 +645,21 @@ void render_thumbnail(uint16_t *framebuffer, const Thumbnail *thumb) {
     // Draw inner background
     render_fill_rect(framebuffer, start_x, start_y, display_width, display_height, BG_COLOR);
     
+    // Fast path: pre-sized thumbnails are blitted 1:1 without rescaling
+    if (display_width == thumb->width && display_height == thumb->height) {
+        for (int y = 0; y < display_height; y++) {
+            const uint16_t *src = thumb->data + y * thumb->width;
+            uint16_t *dst = framebuffer + (start_y + y) * SCREEN_WIDTH + start_x;
+            for (int x = 0; x < display_width; x++) {
+                // Only draw non-black pixels, let dark gray background show through
+                if (src[x] != 0x0000) {
+                    dst[x] = src[x];
+                }
+            }
+        }
+        return;
+    }
+
     // Draw scaled thumbnail (simple nearest neighbor for now)
     for (int y = 0; y < display_height; y++) {
         for (int x = 0; x < display_width; x++) {
@@ -37,8 +37,8 @@
 // Text scrolling for filenames
 #define MAX_FILENAME_DISPLAY_LEN 20 // Max length for selected item (with scrolling)
 #define MAX_UNSELECTED_DISPLAY_LEN 10 // Max length for unselected items (to avoid thumbnail overlap)
-#define SCROLL_DELAY_FRAMES 60      // Delay before scrolling starts (1 second at 60fps)
-#define SCROLL_SPEED_FRAMES 8       // Frames between scroll steps (slower = easier to read)
+#define SCROLL_DELAY_FRAMES 60      // Pause before scrolling and at each end (1 second at 60fps)
+#define SCROLL_PIXELS_PER_FRAME 1   // Marquee speed
 
 // Initialize rendering system
 void render_init(uint16_t *framebuffer);
@@ -56,6 +56,15 @@ void render_rounded_rect(uint16_t *framebuffer, int x, int y, int width, int hei
 void render_text_pillbox(uint16_t *framebuffer, int x, int y, const char *text, 
                         uint16_t bg_color, uint16_t text_color, int padding);
 
+// Same as render_text_pillbox(), but drawn from a cached bitmap. Use for
+// labels that stay the same across frames (titles, hints), not ones that
+// change with the selection.
+void render_label_pillbox(uint16_t *framebuffer, int x, int y, const char *text,
+                          uint16_t bg_color, uint16_t text_color, int padding);
+
+// Draw a legend hint in its rounded pill, text at (x, y) (cached)
+void render_legend_pill(uint16_t *framebuffer, int x, int y, const char *text);
+
 // Draw menu header with title
 void render_header(uint16_t *framebuffer, const char *title);
 
@@ -67,10 +76,20 @@ void render_header(uint16_t *framebuffer, const char *title);
 // Draw menu legend at bottom
 void render_legend(uint16_t *framebuffer, int x_button_mode);
 
-// Draw a menu item (file or folder)
+// Draw a menu item (file or folder). A selected name longer than
+// MAX_FILENAME_DISPLAY_LEN characters is shown in a scrolling marquee.
 void render_menu_item(uint16_t *framebuffer, int index, const char *name, int is_dir,
                      int is_selected, int scroll_offset, int is_favorited);
 
+// Restart the marquee from the beginning (call when the selection changes)
+void render_marquee_reset(void);
+
+// Stop animating the marquee (call before redrawing the screen)
+void render_marquee_stop(void);
+
+// Advance the marquee by one frame and redraw just its window
+void render_marquee_tick(uint16_t *framebuffer);
+
 // Thumbnail functions
 typedef struct {
     uint16_t *data;
@@ -0,0 +1,186 @@
+/*
+ * Bake a TrueType font into FrogUI's pre-rasterized .bfont format
+ * Usage: bake_font <font.ttf> <pixel_size> <output.bfont>
+ *
+ * Host tool - build it with `make fonts` from the repository root.
+ * The glyph set and metrics match the atlas font.c builds at runtime.
+ */
+
+#define STB_TRUETYPE_IMPLEMENTATION
+#include "../stb_truetype.h"
+#include "../font_baked.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FIRST_CHAR 32
+#define LAST_CHAR 126
+#define GLYPH_COUNT (LAST_CHAR - FIRST_CHAR + 1)
+
+typedef struct {
+    int glyph_index;
+    int advance;
+    int xoff;
+    int yoff;
+    int width;
+    int height;
+    int offset;
+} Glyph;
+
+static void put_le16(unsigned char *p, int v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+}
+
+static void put_le32(unsigned char *p, unsigned int v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+}
+
+static unsigned char *read_file(const char *path, long *size) {
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return NULL;
+
+    fseek(fp, 0, SEEK_END);
+    *size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    unsigned char *data = (unsigned char*)malloc(*size);
+    if (data && fread(data, 1, *size, fp) != (size_t)*size) {
+        free(data);
+        data = NULL;
+    }
+    fclose(fp);
+    return data;
+}
+
+int main(int argc, char **argv) {
+    if (argc != 4) {
+        fprintf(stderr, "Usage: %s <font.ttf> <pixel_size> <output.bfont>\n", argv[0]);
+        return 1;
+    }
+
+    int pixel_size = atoi(argv[2]);
+    if (pixel_size <= 0 || pixel_size > 255) {
+        fprintf(stderr, "Error: invalid pixel size '%s'\n", argv[2]);
+        return 1;
+    }
+
+    long ttf_size;
+    unsigned char *ttf = read_file(argv[1], &ttf_size);
+    if (!ttf) {
+        fprintf(stderr, "Error: cannot read '%s'\n", argv[1]);
+        return 1;
+    }
+
+    stbtt_fontinfo info;
+    if (!stbtt_InitFont(&info, ttf, stbtt_GetFontOffsetForIndex(ttf, 0))) {
+        fprintf(stderr, "Error: '%s' is not a valid TrueType font\n", argv[1]);
+        return 1;
+    }
+
+    float scale = stbtt_ScaleForPixelHeight(&info, (float)pixel_size);
+
+    int ascent, descent, line_gap;
+    stbtt_GetFontVMetrics(&info, &ascent, &descent, &line_gap);
+    int baseline = (int)(ascent * scale);
+
+    // Metrics and bitmap layout
+    Glyph glyphs[GLYPH_COUNT];
+    int bitmap_size = 0;
+    for (int i = 0; i < GLYPH_COUNT; i++) {
+        Glyph *g = &glyphs[i];
+        memset(g, 0, sizeof(*g));
+        g->glyph_index = stbtt_FindGlyphIndex(&info, FIRST_CHAR + i);
+        if (g->glyph_index == 0) continue;
+
+        int advance_width, left_side_bearing;
+        stbtt_GetGlyphHMetrics(&info, g->glyph_index, &advance_width, &left_side_bearing);
+        g->advance = (int)(advance_width * scale);
+
+        int x0, y0, x1, y1;
+        stbtt_GetGlyphBitmapBox(&info, g->glyph_index, scale, scale, &x0, &y0, &x1, &y1);
+        g->xoff = x0;
+        g->yoff = y0;
+        g->width = x1 - x0;
+        g->height = y1 - y0;
+        g->offset = bitmap_size;
+        bitmap_size += BAKED_FONT_ROW_BYTES(g->width) * g->height;
+    }
+
+    int glyph_table_size = GLYPH_COUNT * BAKED_FONT_GLYPH_SIZE;
+    int kerning_size = GLYPH_COUNT * GLYPH_COUNT;
+    int total_size = BAKED_FONT_HEADER_SIZE + glyph_table_size + kerning_size + bitmap_size;
+
+    unsigned char *out = (unsigned char*)calloc(1, total_size);
+    if (!out) {
+        fprintf(stderr, "Error: out of memory\n");
+        return 1;
+    }
+
+    // Header
+    memcpy(out, BAKED_FONT_MAGIC, 4);
+    put_le16(out + 4, BAKED_FONT_VERSION);
+    put_le16(out + 6, pixel_size);
+    put_le16(out + 8, baseline);
+    put_le16(out + 10, FIRST_CHAR);
+    put_le16(out + 12, GLYPH_COUNT);
+    put_le32(out + 16, bitmap_size);
+
+    // Glyph table
+    unsigned char *p = out + BAKED_FONT_HEADER_SIZE;
+    for (int i = 0; i < GLYPH_COUNT; i++, p += BAKED_FONT_GLYPH_SIZE) {
+        put_le16(p + 0, glyphs[i].glyph_index);
+        put_le16(p + 2, glyphs[i].advance);
+        put_le16(p + 4, glyphs[i].xoff);
+        put_le16(p + 6, glyphs[i].yoff);
+        put_le16(p + 8, glyphs[i].width);
+        put_le16(p + 10, glyphs[i].height);
+        put_le32(p + 12, glyphs[i].offset);
+    }
+
+    // Kerning table
+    signed char *kerning = (signed char*)p;
+    for (int a = 0; a < GLYPH_COUNT; a++) {
+        for (int b = 0; b < GLYPH_COUNT; b++) {
+            int kern = 0;
+            if (glyphs[a].glyph_index && glyphs[b].glyph_index) {
+                kern = (int)(stbtt_GetGlyphKernAdvance(&info, glyphs[a].glyph_index,
+                                                       glyphs[b].glyph_index) * scale);
+            }
+            kerning[a * GLYPH_COUNT + b] = (signed char)kern;
+        }
+    }
+    p += kerning_size;
+
+    // Bitmaps - rasterize at 8 bits, store as packed 4-bit coverage
+    for (int i = 0; i < GLYPH_COUNT; i++) {
+        if (glyphs[i].width > 0 && glyphs[i].height > 0) {
+            unsigned char *coverage = (unsigned char*)malloc(glyphs[i].width * glyphs[i].height);
+            if (!coverage) {
+                fprintf(stderr, "Error: out of memory\n");
+                return 1;
+            }
+            stbtt_MakeGlyphBitmap(&info, coverage, glyphs[i].width, glyphs[i].height,
+                                  glyphs[i].width, scale, scale, glyphs[i].glyph_index);
+            baked_font_pack_coverage(coverage, glyphs[i].width, glyphs[i].height, p + glyphs[i].offset);
+            free(coverage);
+        }
+    }
+
+    FILE *fp = fopen(argv[3], "wb");
+    if (!fp || fwrite(out, 1, total_size, fp) != (size_t)total_size) {
+        fprintf(stderr, "Error: cannot write '%s'\n", argv[3]);
+        if (fp) fclose(fp);
+        return 1;
+    }
+    fclose(fp);
+
+    printf("Baked %s at %dpx -> %s (%d bytes)\n", argv[1], pixel_size, argv[3], total_size);
+
+    free(out);
+    free(ttf);
+    return 0;
+}
@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+"""
+Benchmark FrogUI's directory scanning against synthetic ROM libraries
+Usage: python bench_library.py [--sizes 100,1000,10000,100000] [--work DIR]
+
+For every size, generate_library.py builds an SD card with that many files
+per system. The unix build of the core is then run under
+scripts/host_frontend (both built with `make host`) for each scenario:
+
+  cold boot    retro_init() with no empty-folder cache (rebuilds it)
+  warm boot    retro_init() with the cache written by the cold boot
+  enter        open the first system folder (scan + sort)
+  scroll       move down through the folder, loading a thumbnail each step
+               (time and I/O are per step)
+  random       pick a random game from the root menu
+
+Each row reports wall time, file system calls made by the core, the largest
+scan and sort times from the profiler log, and the peak heap of the run.
+Run from the repository root; nothing is written outside --work.
+"""
+
+import re
+import sys
+import shutil
+import argparse
+import subprocess
+from pathlib import Path
+
+REPO_DIR = Path(__file__).resolve().parent.parent
+FRONTEND = REPO_DIR / 'scripts' / 'host_frontend'
+CORE = REPO_DIR / 'menu_libretro.so'
+
+# Root menu: Recent games, Favorites, Random game, then the systems
+ENTER_FIRST_SYSTEM = ['D', 'D', 'D', 'A']
+PICK_RANDOM_GAME = ['D', 'D', 'A']
+SCROLL_STEPS = 20
+
+# Enough idle frames to close one profiler window (PROFILE_WINDOW_FRAMES)
+FLUSH_PROFILE = ['w60']
+
+TOKEN_LINE = re.compile(r'^(\S+)\s+(\d+) frames\s+(\d+) us\s+(\d+) io\s+(\d+) KB heap$')
+INIT_LINE = re.compile(r'^init (\d+) us')
+IO_LINE = re.compile(r'^io (\d+) calls \((\d+) in init\)')
+HEAP_LINE = re.compile(r'^heap peak (\d+) KB')
+
+def run_frontend(root, tokens):
+    """Run one scripted session, returning the parsed token lines and summary"""
+    log = root / 'frogui' / 'profile.log'
+    if log.exists():
+        log.unlink()
+
+    cmd = [str(FRONTEND), '-r', str(root), '-t', '-V', 'frogui_show_frametime=true',
+           str(CORE)] + tokens + FLUSH_PROFILE
+    result = subprocess.run(cmd, cwd=REPO_DIR, capture_output=True, text=True)
+    if result.returncode != 0:
+        print(result.stderr)
+        sys.exit(1)
+
+    run = {'tokens': [], 'init_us': 0, 'init_io': 0, 'heap_kb': 0, 'scan_us': 0, 'sort_us': 0}
+    for line in result.stdout.splitlines():
+        match = TOKEN_LINE.match(line)
+        if match:
+            run['tokens'].append((match.group(1), int(match.group(3)), int(match.group(4))))
+    for line in result.stderr.splitlines():
+        if INIT_LINE.match(line):
+            run['init_us'] = int(INIT_LINE.match(line).group(1))
+        elif IO_LINE.match(line):
+            run['init_io'] = int(IO_LINE.match(line).group(2))
+        elif HEAP_LINE.match(line):
+            run['heap_kb'] = int(HEAP_LINE.match(line).group(1))
+
+    # Profiler lines look like "frame 12/40/900  input 0/3/850  scan ..."
+    if log.exists():
+        for line in log.read_text().splitlines():
+            stages = dict(re.findall(r'(\w+) \d+/\d+/(\d+)', line))
+            run['scan_us'] = max(run['scan_us'], int(stages.get('scan', 0)))
+            run['sort_us'] = max(run['sort_us'], int(stages.get('sort', 0)))
+    return run
+
+def token_totals(run, first, last=None):
+    """Summed time and I/O of the script tokens in [first, last)"""
+    tokens = run['tokens'][first:last]
+    return sum(t[1] for t in tokens), sum(t[2] for t in tokens), len(tokens)
+
+def bench_size(root, size, args):
+    subprocess.run([sys.executable, str(REPO_DIR / 'scripts' / 'generate_library.py'), str(root),
+                    '--force', '--files', str(size), '--systems', str(args.systems),
+                    '--empty', str(args.empty), '--seed', str(args.seed)],
+                   check=True, stdout=subprocess.DEVNULL)
+
+    rows = []
+    cache = root / 'configs' / 'frogui_empty_dirs.cache'
+    if cache.exists():
+        cache.unlink()
+
+    for name in ('cold boot', 'warm boot'):
+        run = run_frontend(root, [])
+        rows.append((name, run['init_us'], run['init_io'], run))
+
+    enter = len(ENTER_FIRST_SYSTEM) - 1
+    run = run_frontend(root, ENTER_FIRST_SYSTEM)
+    us, io, _ = token_totals(run, enter, enter + 1)
+    rows.append(('enter', us, io, run))
+
+    run = run_frontend(root, ENTER_FIRST_SYSTEM + ['D'] * SCROLL_STEPS)
+    us, io, steps = token_totals(run, enter + 1, enter + 1 + SCROLL_STEPS)
+    rows.append(('scroll', us // max(steps, 1), io // max(steps, 1), run))
+
+    pick = len(PICK_RANDOM_GAME) - 1
+    run = run_frontend(root, PICK_RANDOM_GAME)
+    us, io, _ = token_totals(run, pick, pick + 1)
+    rows.append(('random', us, io, run))
+
+    for name, us, io, run in rows:
+        print(f"{size:>7} {name:<10} {us / 1000:>9.2f} {io:>8} "
+              f"{run['scan_us'] / 1000:>9.2f} {run['sort_us'] / 1000:>9.2f} {run['heap_kb']:>9}")
+
+def main():
+    parser = argparse.ArgumentParser(description="Benchmark FrogUI scanning on synthetic libraries")
+    parser.add_argument('--sizes', default='100,1000,10000,100000',
+                        help="comma separated files per system (default: 100,1000,10000,100000)")
+    parser.add_argument('--systems', type=int, default=8, help="systems with games (default: 8)")
+    parser.add_argument('--empty', type=int, default=4, help="empty system folders (default: 4)")
+    parser.add_argument('--seed', type=int, default=1, help="library random seed (default: 1)")
+    parser.add_argument('--work', default='/tmp/frogui_bench',
+                        help="directory for the generated libraries (default: /tmp/frogui_bench)")
+    parser.add_argument('--keep', action='store_true', help="keep the generated libraries")
+    args = parser.parse_args()
+
+    if not FRONTEND.exists() or not CORE.exists():
+        print("Error: build the core and frontend first with `make host`")
+        sys.exit(1)
+
+    work = Path(args.work)
+    work.mkdir(parents=True, exist_ok=True)
+
+    print(f"{'files':>7} {'scenario':<10} {'time (ms)':>9} {'io calls':>8} "
+          f"{'scan (ms)':>9} {'sort (ms)':>9} {'heap (KB)':>9}")
+    for size in (int(s) for s in args.sizes.split(',')):
+        bench_size(work / f"lib_{size}", size, args)
+
+    if not args.keep:
+        for size in args.sizes.split(','):
+            shutil.rmtree(work / f"lib_{int(size)}", ignore_errors=True)
+
+if __name__ == '__main__':
+    main()
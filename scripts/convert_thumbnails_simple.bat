@@ -26,20 +26,20 @@ pause
 exit /b 1
 
 :check_pillow
-REM Check if PIL/Pillow is installed
-python -c "from PIL import Image" >nul 2>&1
+REM Check if PIL/Pillow and numpy are installed
+python -c "from PIL import Image; import numpy" >nul 2>&1
 if errorlevel 1 goto install_pillow
 goto run_conversion
 
 :install_pillow
-echo Error: Pillow not found!
-echo Installing Pillow...
-python -m pip install Pillow
+echo Error: Pillow or numpy not found!
+echo Installing Pillow and numpy...
+python -m pip install Pillow numpy
 if errorlevel 1 goto pillow_failed
 goto run_conversion
 
 :pillow_failed
-echo Failed to install Pillow
+echo Failed to install Pillow and numpy
 pause
 exit /b 1
 
@@ -17,13 +17,13 @@ if ! command -v python3 &> /dev/null; then
     exit 1
 fi
 
-# Check if PIL/Pillow is installed
-if ! python3 -c "from PIL import Image" 2>/dev/null; then
-    echo "Error: Pillow (PIL) not found!"
-    echo "Installing Pillow..."
-    python3 -m pip install Pillow
+# Check if PIL/Pillow and numpy are installed
+if ! python3 -c "from PIL import Image; import numpy" 2>/dev/null; then
+    echo "Error: Pillow (PIL) or numpy not found!"
+    echo "Installing Pillow and numpy..."
+    python3 -m pip install Pillow numpy
     if [ $? -ne 0 ]; then
-        echo "Failed to install Pillow"
+        echo "Failed to install Pillow and numpy"
         exit 1
     fi
 fi
@@ -1,56 +1,101 @@
 #!/usr/bin/env python3
 """
 Convert PNG thumbnails to raw RGB565 format for FrogOS/SF2000
-Usage: python convert_to_rgb565.py <roms_directory>
+Usage: python convert_to_rgb565.py <roms_directory> [--jobs N] [--force]
+
+Images are converted in parallel and written pre-sized to the on-screen
+thumbnail box used by render_thumbnail() (160x200 max), so the device can
+blit them 1:1 without rescaling. PNGs whose .rgb565 output is already newer
+than the source are skipped unless --force is given.
 """
 
 import os
 import sys
-import struct
+import argparse
+from multiprocessing import Pool
 from pathlib import Path
+
+import numpy as np
 from PIL import Image
 
-def rgb888_to_rgb565(r, g, b):
-    """Convert 8-bit RGB values to 16-bit RGB565 format"""
+# Must match THUMBNAIL_MAX_WIDTH / THUMBNAIL_MAX_HEIGHT in render.h
+BOX_WIDTH = 160
+BOX_HEIGHT = 200
+
+# Output canvases - must match the dimension table in load_raw_rgb565()
+CANVAS_WIDE = (160, 128)    # Landscape box art / screenshots (5:4)
+CANVAS_SQUARE = (160, 160)  # Square or near-square images
+CANVAS_TALL = (160, 200)    # Portrait box art (4:5)
+
+def pick_canvas(width, height):
+    """Pick the output canvas that best matches the source aspect ratio"""
+    aspect = width / height
+    if aspect > 1.1:
+        return CANVAS_WIDE
+    if aspect < 0.9:
+        return CANVAS_TALL
+    return CANVAS_SQUARE
+
+def rgb888_to_rgb565(pixels):
+    """Convert an (H, W, 3) uint8 array to little-endian RGB565 bytes"""
     # RGB565: RRRRR GGGGGG BBBBB (5 bits R, 6 bits G, 5 bits B)
-    r5 = (r >> 3) & 0x1F  # 5 bits
-    g6 = (g >> 2) & 0x3F  # 6 bits
-    b5 = (b >> 3) & 0x1F  # 5 bits
-    return (r5 << 11) | (g6 << 5) | b5
+    rgb = pixels.astype(np.uint16)
+    rgb565 = ((rgb[..., 0] >> 3) << 11) | ((rgb[..., 1] >> 2) << 5) | (rgb[..., 2] >> 3)
+    return rgb565.astype('<u2').tobytes()
 
-def convert_image_to_rgb565(input_path, output_path, max_width, max_height):
-    """Convert a PNG image to raw RGB565 format"""
+def convert_image_to_rgb565(input_path, output_path):
+    """Convert a PNG image to raw RGB565 format, padded to its canvas"""
     try:
         # Open and convert image to RGB
-        img = Image.open(input_path)
-        img = img.convert('RGB')
-
-        # Resize if needed, maintaining aspect ratio
-        img.thumbnail((max_width, max_height), Image.Resampling.LANCZOS)
-
-        # Get pixel data
-        pixels = img.load()
-        width, height = img.size
-
-        # Convert to RGB565 and write
-        with open(output_path, 'wb') as f:
-            for y in range(height):
-                for x in range(width):
-                    r, g, b = pixels[x, y]
-                    rgb565 = rgb888_to_rgb565(r, g, b)
-                    # Write as little-endian uint16
-                    f.write(struct.pack('<H', rgb565))
-
-        return True, width, height
+        with Image.open(input_path) as src:
+            img = src.convert('RGB')
+
+        canvas_w, canvas_h = pick_canvas(*img.size)
+
+        # Resize to fit the canvas, maintaining aspect ratio
+        img.thumbnail((canvas_w, canvas_h), Image.Resampling.LANCZOS)
+
+        # Center on a black canvas - black pixels are drawn transparent,
+        # so the padding shows the thumbnail frame background on device
+        canvas = Image.new('RGB', (canvas_w, canvas_h), (0, 0, 0))
+        canvas.paste(img, ((canvas_w - img.width) // 2, (canvas_h - img.height) // 2))
+
+        data = rgb888_to_rgb565(np.asarray(canvas))
+
+        # Write to a temp file first so an interrupted run never leaves a
+        # truncated thumbnail that looks up to date
+        tmp_path = output_path.with_suffix('.rgb565.tmp')
+        with open(tmp_path, 'wb') as f:
+            f.write(data)
+        os.replace(tmp_path, output_path)
+
+        return True, canvas_w, canvas_h, len(data), None
     except Exception as e:
-        return False, 0, 0
+        return False, 0, 0, 0, str(e)
+
+def is_up_to_date(png_file, rgb565_file):
+    """Check if the output exists and is newer than the source PNG"""
+    try:
+        return rgb565_file.stat().st_mtime >= png_file.stat().st_mtime
+    except OSError:
+        return False
+
+def convert_job(png_file):
+    """Pool worker: convert one PNG next to itself"""
+    rgb565_file = png_file.with_suffix('.rgb565')
+    success, w, h, size, error = convert_image_to_rgb565(png_file, rgb565_file)
+    return png_file, success, w, h, size, error
 
 def main():
-    if len(sys.argv) < 2:
-        print("Usage: python convert_to_rgb565.py <roms_directory>")
-        sys.exit(1)
+    parser = argparse.ArgumentParser(description="Convert PNG thumbnails to RGB565 for FrogUI")
+    parser.add_argument('roms_directory', help="ROMS directory containing .res thumbnail folders")
+    parser.add_argument('-j', '--jobs', type=int, default=os.cpu_count() or 1,
+                        help="number of worker processes (default: all CPUs)")
+    parser.add_argument('-f', '--force', action='store_true',
+                        help="reconvert even if the output is newer than the PNG")
+    args = parser.parse_args()
 
-    roms_dir = Path(sys.argv[1])
+    roms_dir = Path(args.roms_directory)
 
     if not roms_dir.exists():
         print(f"Error: Directory '{roms_dir}' not found")
@@ -60,51 +105,38 @@ def main():
     print(f"Scanning: {roms_dir}")
 
     count = 0
-    converted = 0
-    errors = 0
+    skipped = 0
+    pending = []
 
     # Find all PNG files in .res subdirectories
     for png_file in roms_dir.rglob('*.png'):
         if '.res' in png_file.parts:
             count += 1
-            rgb565_file = png_file.with_suffix('.rgb565')
-
-            print(f"Converting: {png_file.name}")
+            if not args.force and is_up_to_date(png_file, png_file.with_suffix('.rgb565')):
+                skipped += 1
+                continue
+            pending.append(png_file)
 
-            # Determine size based on image aspect ratio
-            try:
-                with Image.open(png_file) as img:
-                    width, height = img.size
+    print(f"Found {count} PNG files, {len(pending)} to convert using {args.jobs} workers")
 
-                if width > height:
-                    # Wide image - 250x200 max
-                    max_w, max_h = 250, 200
-                    print(f"  Wide image ({width}x{height}): resizing to {max_w}x{max_h} max")
-                else:
-                    # Square/vertical - 200x200 max
-                    max_w, max_h = 200, 200
-                    print(f"  Square/vertical ({width}x{height}): resizing to {max_w}x{max_h} max")
-
-                success, final_w, final_h = convert_image_to_rgb565(
-                    png_file, rgb565_file, max_w, max_h
-                )
+    converted = 0
+    errors = 0
 
+    if pending:
+        with Pool(processes=max(1, args.jobs)) as pool:
+            for png_file, success, w, h, size, error in pool.imap_unordered(convert_job, pending, chunksize=16):
                 if success:
                     converted += 1
-                    file_size = rgb565_file.stat().st_size
-                    print(f"  Success: {final_w}x{final_h} ({file_size} bytes)")
+                    print(f"Converted: {png_file.name} -> {w}x{h} ({size} bytes)")
                 else:
                     errors += 1
-                    print(f"  Error converting {png_file}")
-
-            except Exception as e:
-                errors += 1
-                print(f"  Error: {e}")
+                    print(f"  Error converting {png_file}: {error}")
 
     print()
     print("Conversion complete!")
     print(f"Found: {count} PNG files")
     print(f"Converted: {converted} files")
+    print(f"Up to date: {skipped} files")
     print(f"Errors: {errors} files")
     print()
     print("RGB565 files created - ready for SF2000!")
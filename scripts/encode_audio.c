@@ -0,0 +1,392 @@
+/*
+ * Compress a PCM WAV for FrogUI's menu music or navigation sound
+ * Usage: encode_audio <adpcm|qoa> <input.wav> <output>
+ *
+ * Host tool - build it with `make host` from the repository root.
+ * adpcm writes an IMA-ADPCM WAV (4 bits per sample), qoa a QOA file
+ * (3.2 bits per sample, better quality). The input can be 8 or 16-bit,
+ * mono or stereo, at any rate; the core resamples to 44.1 kHz while
+ * playing. Name the output menu_music.wav / .qoa or navigation.wav / .qoa.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#define ADPCM_BLOCK_BYTES 512  // Per channel
+#define QOA_SLICE_LEN 20
+#define QOA_FRAME_LEN 5120
+
+typedef struct {
+    int channels;
+    int sample_rate;
+    int frames;
+    int16_t *samples;  // Interleaved
+} Pcm;
+
+static int read_le16(const unsigned char *p) {
+    return p[0] | (p[1] << 8);
+}
+
+static unsigned int read_le32(const unsigned char *p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+static void put_le16(unsigned char *p, int v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+}
+
+static void put_le32(unsigned char *p, unsigned int v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+}
+
+static void put_be16(unsigned char *p, int v) {
+    p[0] = (v >> 8) & 0xFF;
+    p[1] = v & 0xFF;
+}
+
+static void put_be32(unsigned char *p, unsigned int v) {
+    p[0] = (v >> 24) & 0xFF;
+    p[1] = (v >> 16) & 0xFF;
+    p[2] = (v >> 8) & 0xFF;
+    p[3] = v & 0xFF;
+}
+
+static int clamp16(int v) {
+    if (v > 32767) return 32767;
+    if (v < -32768) return -32768;
+    return v;
+}
+
+// Load an 8 or 16-bit PCM WAV with one or two channels
+static int load_wav(const char *path, Pcm *pcm) {
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return 0;
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    unsigned char *buf = malloc(size);
+    if (!buf || fread(buf, 1, size, fp) != (size_t)size) {
+        fclose(fp);
+        free(buf);
+        return 0;
+    }
+    fclose(fp);
+
+    int ok = 0, bits = 0;
+    if (size >= 12 && !memcmp(buf, "RIFF", 4) && !memcmp(buf + 8, "WAVE", 4)) {
+        long pos = 12;
+        while (pos + 8 <= size) {
+            unsigned int chunk_size = read_le32(buf + pos + 4);
+            const unsigned char *chunk = buf + pos + 8;
+            if (chunk_size > (unsigned int)(size - pos - 8)) chunk_size = size - pos - 8;
+
+            if (!memcmp(buf + pos, "fmt ", 4) && chunk_size >= 16) {
+                if (read_le16(chunk) != 1) break;
+                pcm->channels = read_le16(chunk + 2);
+                pcm->sample_rate = read_le32(chunk + 4);
+                bits = read_le16(chunk + 14);
+                if (pcm->channels < 1 || pcm->channels > 2 || (bits != 8 && bits != 16)) break;
+            } else if (!memcmp(buf + pos, "data", 4) && bits) {
+                pcm->frames = chunk_size / (pcm->channels * bits / 8);
+                int count = pcm->frames * pcm->channels;
+                pcm->samples = malloc((size_t)count * sizeof(int16_t));
+                if (!pcm->samples) break;
+                for (int i = 0; i < count; i++) {
+                    pcm->samples[i] = bits == 8 ? (chunk[i] - 128) * 256 : (int16_t)read_le16(chunk + i * 2);
+                }
+                ok = pcm->frames > 0;
+                break;
+            }
+            pos += 8 + chunk_size + (chunk_size & 1);
+        }
+    }
+    free(buf);
+    return ok;
+}
+
+// IMA-ADPCM, the same tables and rounding as the decoder in audio.c
+
+static const int ima_steps[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442,
+    11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+    32767
+};
+
+static const int ima_index_steps[8] = { -1, -1, -1, -1, 2, 4, 6, 8 };
+
+typedef struct {
+    int predictor;
+    int index;
+} ImaState;
+
+static int ima_encode(ImaState *state, int sample) {
+    int step = ima_steps[state->index];
+    int diff = sample - state->predictor;
+    int nibble = 0;
+    if (diff < 0) {
+        nibble = 8;
+        diff = -diff;
+    }
+    if (diff >= step) { nibble |= 4; diff -= step; }
+    if (diff >= step >> 1) { nibble |= 2; diff -= step >> 1; }
+    if (diff >= step >> 2) { nibble |= 1; }
+
+    // Track what the decoder will reconstruct
+    int delta = step >> 3;
+    if (nibble & 1) delta += step >> 2;
+    if (nibble & 2) delta += step >> 1;
+    if (nibble & 4) delta += step;
+    state->predictor = clamp16(nibble & 8 ? state->predictor - delta : state->predictor + delta);
+    state->index += ima_index_steps[nibble & 7];
+    if (state->index < 0) state->index = 0;
+    if (state->index > 88) state->index = 88;
+    return nibble;
+}
+
+static int write_adpcm(const Pcm *pcm, FILE *fp) {
+    int channels = pcm->channels;
+    int block_align = ADPCM_BLOCK_BYTES * channels;
+    int block_frames = 1 + (block_align - 4 * channels) / (4 * channels) * 8;
+    int blocks = (pcm->frames + block_frames - 1) / block_frames;
+
+    // The last block only holds the groups of eight samples it needs, so
+    // looped music gets at most seven samples of padding
+    int last_frames = pcm->frames - (blocks - 1) * block_frames;
+    int last_align = 4 * channels + (last_frames - 1 + 7) / 8 * 4 * channels;
+    unsigned int data_size = (unsigned int)(blocks - 1) * block_align + last_align;
+
+    unsigned char header[60];
+    memcpy(header, "RIFF", 4);
+    put_le32(header + 4, 52 + data_size);
+    memcpy(header + 8, "WAVEfmt ", 8);
+    put_le32(header + 16, 20);
+    put_le16(header + 20, 0x11);
+    put_le16(header + 22, channels);
+    put_le32(header + 24, pcm->sample_rate);
+    put_le32(header + 28, (unsigned int)((uint64_t)pcm->sample_rate * block_align / block_frames));
+    put_le16(header + 32, block_align);
+    put_le16(header + 34, 4);
+    put_le16(header + 36, 2);
+    put_le16(header + 38, block_frames);
+    memcpy(header + 40, "fact", 4);
+    put_le32(header + 44, 4);
+    put_le32(header + 48, pcm->frames);
+    memcpy(header + 52, "data", 4);
+    put_le32(header + 56, data_size);
+    if (fwrite(header, 1, sizeof(header), fp) != sizeof(header)) return 0;
+
+    ImaState state[2] = { { 0, 0 }, { 0, 0 } };
+    unsigned char *block = malloc(block_align);
+    if (!block) return 0;
+
+    // Padding repeats the final sample
+    for (int b = 0; b < blocks; b++) {
+        int first = b * block_frames;
+        #define SAMPLE(frame, c) pcm->samples[((frame) < pcm->frames ? (frame) : pcm->frames - 1) * channels + (c)]
+
+        for (int c = 0; c < channels; c++) {
+            state[c].predictor = SAMPLE(first, c);
+            put_le16(block + c * 4, state[c].predictor);
+            block[c * 4 + 2] = state[c].index;
+            block[c * 4 + 3] = 0;
+        }
+
+        unsigned char *p = block + channels * 4;
+        int frames = b == blocks - 1 ? last_frames : block_frames;
+        for (int frame = 1; frame < frames; frame += 8) {
+            for (int c = 0; c < channels; c++) {
+                for (int i = 0; i < 8; i += 2) {
+                    int low = ima_encode(&state[c], SAMPLE(first + frame + i, c));
+                    int high = ima_encode(&state[c], SAMPLE(first + frame + i + 1, c));
+                    *p++ = low | (high << 4);
+                }
+            }
+        }
+        #undef SAMPLE
+
+        size_t bytes = p - block;
+        if (fwrite(block, 1, bytes, fp) != bytes) {
+            free(block);
+            return 0;
+        }
+    }
+    free(block);
+    return 1;
+}
+
+// QOA, the same tables as the decoder in audio.c
+
+static const int qoa_scalefactors[16] = {
+    1, 7, 21, 45, 84, 138, 211, 304, 421, 562, 731, 928, 1157, 1419, 1715, 2048
+};
+
+static const int qoa_dequant_quarters[4] = { 3, 10, 18, 28 };
+
+static int qoa_dequant[16][8];
+
+typedef struct {
+    int history[4];
+    int weights[4];
+} QoaLms;
+
+static int qoa_predict(const QoaLms *lms) {
+    int prediction = 0;
+    for (int i = 0; i < 4; i++) prediction += lms->weights[i] * lms->history[i];
+    return prediction >> 13;
+}
+
+static void qoa_update(QoaLms *lms, int sample, int residual) {
+    int delta = residual >> 4;
+    for (int i = 0; i < 4; i++) lms->weights[i] += lms->history[i] < 0 ? -delta : delta;
+    for (int i = 0; i < 3; i++) lms->history[i] = lms->history[i + 1];
+    lms->history[3] = sample;
+}
+
+// Encode one slice of one channel, trying every scalefactor and keeping
+// the one with the smallest squared error
+static uint64_t qoa_encode_slice(const Pcm *pcm, int start, int end, int c, QoaLms *lms) {
+    uint64_t best_slice = 0;
+    uint64_t best_error = UINT64_MAX;
+    QoaLms best_lms = *lms;
+
+    for (int s = 0; s < 16; s++) {
+        QoaLms trial = *lms;
+        uint64_t slice = s;
+        uint64_t error = 0;
+        for (int i = start; i < end; i++) {
+            int sample = pcm->samples[i * pcm->channels + c];
+            int predicted = qoa_predict(&trial);
+            int residual = sample - predicted;
+
+            int best_q = 0, best_diff = 1 << 30;
+            for (int q = 0; q < 8; q++) {
+                int diff = abs(residual - qoa_dequant[s][q]);
+                if (diff < best_diff) {
+                    best_diff = diff;
+                    best_q = q;
+                }
+            }
+            int dequantized = qoa_dequant[s][best_q];
+            int reconstructed = clamp16(predicted + dequantized);
+            int64_t e = sample - reconstructed;
+            error += (uint64_t)(e * e);
+            if (error >= best_error) break;
+
+            qoa_update(&trial, reconstructed, dequantized);
+            slice = (slice << 3) | best_q;
+        }
+
+        // The frame header stores weights as 16 bits; steer away from
+        // scalefactors that let them grow
+        int64_t weights = 0;
+        for (int i = 0; i < 4; i++) weights += (int64_t)trial.weights[i] * trial.weights[i];
+        int64_t penalty = (weights >> 18) - 0x8FF;
+        if (penalty > 0) error += (uint64_t)(penalty * penalty);
+
+        if (error < best_error) {
+            best_error = error;
+            best_slice = slice << ((QOA_SLICE_LEN - (end - start)) * 3);
+            best_lms = trial;
+        }
+    }
+    *lms = best_lms;
+    return best_slice;
+}
+
+static int write_qoa(const Pcm *pcm, FILE *fp) {
+    for (int s = 0; s < 16; s++) {
+        for (int q = 0; q < 4; q++) {
+            int value = (qoa_scalefactors[s] * qoa_dequant_quarters[q] + 2) / 4;
+            qoa_dequant[s][q * 2] = value;
+            qoa_dequant[s][q * 2 + 1] = -value;
+        }
+    }
+
+    unsigned char header[8];
+    memcpy(header, "qoaf", 4);
+    put_be32(header + 4, pcm->frames);
+    if (fwrite(header, 1, 8, fp) != 8) return 0;
+
+    int channels = pcm->channels;
+    QoaLms lms[2];
+    for (int c = 0; c < channels; c++) {
+        memset(&lms[c], 0, sizeof(lms[c]));
+        lms[c].weights[2] = -(1 << 13);
+        lms[c].weights[3] = 1 << 14;
+    }
+
+    unsigned char *frame = malloc(8 + 2 * 16 + QOA_FRAME_LEN / QOA_SLICE_LEN * 2 * 8);
+    if (!frame) return 0;
+
+    for (int first = 0; first < pcm->frames; first += QOA_FRAME_LEN) {
+        int frames = pcm->frames - first < QOA_FRAME_LEN ? pcm->frames - first : QOA_FRAME_LEN;
+        int slices = (frames + QOA_SLICE_LEN - 1) / QOA_SLICE_LEN;
+        int size = 8 + channels * 16 + slices * channels * 8;
+
+        frame[0] = channels;
+        frame[1] = (pcm->sample_rate >> 16) & 0xFF;
+        frame[2] = (pcm->sample_rate >> 8) & 0xFF;
+        frame[3] = pcm->sample_rate & 0xFF;
+        put_be16(frame + 4, frames);
+        put_be16(frame + 6, size);
+
+        unsigned char *p = frame + 8;
+        for (int c = 0; c < channels; c++, p += 16) {
+            for (int i = 0; i < 4; i++) {
+                put_be16(p + i * 2, lms[c].history[i]);
+                put_be16(p + 8 + i * 2, lms[c].weights[i]);
+            }
+        }
+
+        for (int start = first; start < first + frames; start += QOA_SLICE_LEN) {
+            int end = start + QOA_SLICE_LEN < first + frames ? start + QOA_SLICE_LEN : first + frames;
+            for (int c = 0; c < channels; c++, p += 8) {
+                uint64_t slice = qoa_encode_slice(pcm, start, end, c, &lms[c]);
+                put_be32(p, (unsigned int)(slice >> 32));
+                put_be32(p + 4, (unsigned int)slice);
+            }
+        }
+
+        if (fwrite(frame, 1, size, fp) != (size_t)size) {
+            free(frame);
+            return 0;
+        }
+    }
+    free(frame);
+    return 1;
+}
+
+int main(int argc, char **argv) {
+    if (argc != 4 || (strcmp(argv[1], "adpcm") && strcmp(argv[1], "qoa"))) {
+        fprintf(stderr, "Usage: %s <adpcm|qoa> <input.wav> <output>\n", argv[0]);
+        return 1;
+    }
+
+    Pcm pcm = { 0 };
+    if (!load_wav(argv[2], &pcm)) {
+        fprintf(stderr, "Error: '%s' is not an 8 or 16-bit PCM WAV with 1 or 2 channels\n", argv[2]);
+        return 1;
+    }
+
+    FILE *fp = fopen(argv[3], "wb");
+    int ok = fp && (strcmp(argv[1], "qoa") ? write_adpcm(&pcm, fp) : write_qoa(&pcm, fp));
+    if (fp && fclose(fp) != 0) ok = 0;
+    if (!ok) {
+        fprintf(stderr, "Error: cannot write '%s'\n", argv[3]);
+        return 1;
+    }
+
+    printf("%s: %d frames, %d channel(s) at %d Hz\n", argv[3], pcm.frames, pcm.channels, pcm.sample_rate);
+    free(pcm.samples);
+    return 0;
+}
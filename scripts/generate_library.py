@@ -0,0 +1,200 @@
+#!/usr/bin/env python3
+"""
+Generate a synthetic SD card with a large fake ROM library for benchmarking
+Usage: python generate_library.py <output_directory> [--systems N] [--files N[-M]]
+
+Creates <output>/ROMS/<system>/ folders using the real system folder names
+from console_mappings in frogos.c, filled with empty ROM files. Names mix
+plain titles with long and non-ASCII (UTF-8) ones, a few folders are left
+empty, and a fraction of the games get a .res/<name>.rgb565 thumbnail. The
+thumbnails are hard links to one 160x160 image, so 100k of them cost almost
+no disk space. configs/ and default_configs/ get the stock multicore.opt, so
+the result can be used directly as the -r root of scripts/host_frontend.
+
+The same --seed always produces the same tree.
+"""
+
+import os
+import re
+import sys
+import random
+import shutil
+import argparse
+from pathlib import Path
+
+REPO_DIR = Path(__file__).resolve().parent.parent
+
+# Marks a directory as generated, so --force never deletes anything else
+MARKER_FILE = '.frogui_synthetic'
+
+# Must fit MenuEntry.name in frogos.c (256 bytes including the terminator)
+MAX_NAME_BYTES = 240
+
+# Square canvas from convert_to_rgb565.py
+THUMB_WIDTH = 160
+THUMB_HEIGHT = 160
+
+EXTENSIONS = {
+    'gb': '.gb', 'gbb': '.gb', 'gbgb': '.gb', 'dblcherrygb': '.gb',
+    'gba': '.gba', 'gbaf': '.gba', 'gbaff': '.gba', 'gbav': '.gba', 'mgba': '.gba',
+    'nes': '.nes', 'nesq': '.nes', 'nest': '.nes',
+    'snes': '.sfc', 'snes02': '.sfc',
+    'sega': '.md', 'gpgx': '.md', 'gg': '.gg',
+    'pce': '.pce', 'pcesgx': '.pce', 'ngpc': '.ngc', 'lnx': '.lnx', 'wswan': '.ws',
+    'a26': '.a26', 'a78': '.a78', 'col': '.col', 'msx': '.rom', 'vb': '.vb',
+}
+
+WORDS = [
+    'Super', 'Mega', 'Ultra', 'Hyper', 'Dragon', 'Star', 'Space', 'Ninja', 'Robot',
+    'Castle', 'Quest', 'Legend', 'Warrior', 'Racer', 'Soccer', 'Tennis', 'Golf',
+    'Puzzle', 'Tower', 'Island', 'Knight', 'Shadow', 'Thunder', 'Crystal', 'Battle',
+    'Galaxy', 'Jungle', 'Dungeon', 'Blaster', 'Fighter', 'Pinball', 'Kart', 'Zero',
+    'Adventure', 'Force', 'Hunter', 'Ghost', 'Metal', 'Turbo', 'Wonder', 'Magic',
+]
+
+UNICODE_WORDS = [
+    'Pokémon', 'Édition', 'Über', 'Señor', 'Ōkami', 'Cœur', 'Straße', 'Ærø',
+    'ドラゴン', 'クエスト', 'Крепость', 'Ψ-Force', '電脳', 'Ñandú',
+]
+
+REGIONS = ['(USA)', '(Europe)', '(Japan)', '(USA, Europe)', '(World)', '(Rev 1)']
+
+def system_names():
+    """Folder names from console_mappings in frogos.c, in table order"""
+    source = (REPO_DIR / 'frogos.c').read_text(encoding='utf-8', errors='replace')
+    table = source.split('console_mappings[] = {', 1)[1].split('};', 1)[0]
+    return [name for name in re.findall(r'\{"([^"]+)",', table) if name != 'menu']
+
+def clamp_utf8(name, limit):
+    """Cut a name to at most limit bytes without splitting a character"""
+    data = name.encode('utf-8')[:limit]
+    return data.decode('utf-8', errors='ignore').rstrip()
+
+def make_title(rng, unicode_fraction, long_fraction):
+    use_unicode = rng.random() < unicode_fraction
+    words = UNICODE_WORDS + WORDS if use_unicode else WORDS
+
+    title = ' '.join(rng.choice(words) for _ in range(rng.randint(1, 3)))
+    if rng.random() < 0.3:
+        title += ' ' + str(rng.randint(2, 5))
+    if rng.random() < 0.3:
+        title += ' - ' + ' '.join(rng.choice(words) for _ in range(2))
+
+    if rng.random() < long_fraction:
+        # Long enough to need the marquee and to stress the name buffers
+        while len(title.encode('utf-8')) < MAX_NAME_BYTES - 40:
+            title += ' ' + rng.choice(words)
+
+    return title + ' ' + rng.choice(REGIONS)
+
+def parse_file_range(text):
+    low, _, high = text.partition('-')
+    low = int(low)
+    high = int(high) if high else low
+    if low < 0 or high < low:
+        raise argparse.ArgumentTypeError(f"invalid file count '{text}'")
+    return low, high
+
+def write_thumbnail(path):
+    """A simple 160x160 RGB565 gradient"""
+    data = bytearray()
+    for y in range(THUMB_HEIGHT):
+        for x in range(THUMB_WIDTH):
+            r = x * 31 // (THUMB_WIDTH - 1)
+            g = y * 63 // (THUMB_HEIGHT - 1)
+            pixel = (r << 11) | (g << 5) | 16
+            data += pixel.to_bytes(2, 'little')
+    path.write_bytes(data)
+
+def link_thumbnail(template, path):
+    try:
+        os.link(template, path)
+    except OSError:
+        shutil.copyfile(template, path)
+
+def generate(args):
+    out_dir = Path(args.output_directory)
+    if out_dir.exists() and any(out_dir.iterdir()):
+        if not args.force:
+            print(f"Error: '{out_dir}' is not empty (use --force to replace a generated library)")
+            sys.exit(1)
+        if not (out_dir / MARKER_FILE).exists():
+            print(f"Error: '{out_dir}' was not created by this script, refusing to delete it")
+            sys.exit(1)
+        shutil.rmtree(out_dir)
+
+    rng = random.Random(args.seed)
+    systems = system_names()
+    if args.systems + args.empty > len(systems):
+        print(f"Error: only {len(systems)} system folder names are available")
+        sys.exit(1)
+
+    chosen = rng.sample(systems, args.systems + args.empty)
+    full_systems, empty_systems = chosen[:args.systems], chosen[args.systems:]
+
+    roms_dir = out_dir / 'ROMS'
+    roms_dir.mkdir(parents=True)
+    (out_dir / MARKER_FILE).touch()
+    (out_dir / 'frogui').mkdir()
+    for config_dir in ('configs', 'default_configs'):
+        (out_dir / config_dir).mkdir()
+        shutil.copyfile(REPO_DIR / 'sdcard' / config_dir / 'multicore.opt',
+                        out_dir / config_dir / 'multicore.opt')
+
+    template = out_dir / 'thumbnail.rgb565'
+    write_thumbnail(template)
+
+    total_files = 0
+    total_thumbs = 0
+    low, high = args.files
+    for system in full_systems:
+        system_dir = roms_dir / system
+        res_dir = system_dir / '.res'
+        res_dir.mkdir(parents=True)
+
+        extension = EXTENSIONS.get(system, '.zip')
+        count = rng.randint(low, high)
+        names = set()
+        while len(names) < count:
+            title = clamp_utf8(make_title(rng, args.unicode, args.long),
+                               MAX_NAME_BYTES - len(extension))
+            names.add(title)
+
+        for title in sorted(names):
+            (system_dir / (title + extension)).touch()
+            if rng.random() < args.thumbs:
+                link_thumbnail(template, res_dir / (title + '.rgb565'))
+                total_thumbs += 1
+
+        total_files += count
+        print(f"{system}: {count} files")
+
+    for system in empty_systems:
+        (roms_dir / system).mkdir()
+        print(f"{system}: empty")
+
+    print()
+    print(f"Generated {total_files} files and {total_thumbs} thumbnails in {len(full_systems)} "
+          f"systems, plus {len(empty_systems)} empty folders")
+    print(f"Run it with: ./scripts/host_frontend -r {out_dir} -t ./menu_libretro.so D D D A")
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate a synthetic ROM library for FrogUI benchmarks")
+    parser.add_argument('output_directory', help="SD card root to create")
+    parser.add_argument('--systems', type=int, default=8, help="number of systems with games (default: 8)")
+    parser.add_argument('--files', type=parse_file_range, default=(1000, 1000),
+                        help="files per system, N or MIN-MAX (default: 1000)")
+    parser.add_argument('--empty', type=int, default=4, help="number of empty system folders (default: 4)")
+    parser.add_argument('--thumbs', type=float, default=0.5,
+                        help="fraction of games with a thumbnail (default: 0.5)")
+    parser.add_argument('--unicode', type=float, default=0.1,
+                        help="fraction of names with non-ASCII characters (default: 0.1)")
+    parser.add_argument('--long', type=float, default=0.05,
+                        help="fraction of names near the length limit (default: 0.05)")
+    parser.add_argument('--seed', type=int, default=1, help="random seed (default: 1)")
+    parser.add_argument('-f', '--force', action='store_true',
+                        help="replace an existing generated library")
+    generate(parser.parse_args())
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,201 @@
+#!/usr/bin/env python3
+"""
+Check that FrogUI still draws every screen exactly like the golden frames
+Usage: python golden_frames.py [--update] [--images DIR] [--theme NAME]
+
+Builds a small fixed SD card, runs the unix build of the core under
+scripts/host_frontend (both built with `make host`) and takes a checksum of
+a fixed set of screens in every theme: the root menu, a ROM list with a
+thumbnail, the A-Z picker, the FrogUI settings and the tools menu, plus the
+same screens with the second font in the default theme. The checksums are
+compared with golden_frames.txt next to this script, and the time the core
+took to draw each screen is reported so faster render paths can be checked
+for both speed and pixel differences.
+
+Rendering changes that are meant to change the output are recorded with
+--update; look at the frames written by --images before committing them.
+Exits with status 1 if any screen differs.
+"""
+
+import re
+import sys
+import shutil
+import argparse
+import tempfile
+import subprocess
+from pathlib import Path
+
+REPO_DIR = Path(__file__).resolve().parent.parent
+FRONTEND = REPO_DIR / 'scripts' / 'host_frontend'
+CORE = REPO_DIR / 'menu_libretro.so'
+GOLDEN_FILE = Path(__file__).resolve().parent / 'golden_frames.txt'
+
+DEFAULT_THEME = 'MinUI Style'
+DEFAULT_FONT = 'GamePocket'
+EXTRA_FONTS = ['Monogram']
+
+# Script tokens for each screen from a fresh boot. The root menu is Recent
+# games, Favorites, Random game, gb, nes, snes, Tools (emptyone is hidden).
+SCREENS = [
+    ('root', ['w1']),
+    ('roms', ['D', 'D', 'D', 'A', 'D', 'w30']),
+    ('picker', ['D', 'D', 'D', 'A', 'R']),
+    ('settings', ['S']),
+    ('tools', ['U', 'A']),
+]
+
+# Fixture library: folder -> ROM files. The first game in gb has a thumbnail.
+LIBRARY = {
+    'gb': ['Alleyway.gb', 'Bravo game.gb', 'castlevania adventure.gb', 'Dr. Mario.gb',
+           "Kirby's Dream Land.gb", 'Metroid II - Return of Samus.gb',
+           'Pokemon Red Version (USA, Europe) (SGB Enhanced).gb', 'Tetris.gb',
+           "Zelda - Link's Awakening.gb"],
+    'nes': ['Contra.nes', 'Super Mario Bros.nes', 'Zelda.nes'],
+    'snes': ['x.sfc'],
+    'emptyone': [],
+}
+THUMBNAIL = ('gb', 'Alleyway')
+
+TOKEN_LINE = re.compile(r'^(\S+)\s+\d+ frames\s+(\d+) us')
+CHECKSUM_LINE = re.compile(r'^[0-9a-f]{8}$')
+
+def theme_names():
+    """Theme names in menu order, from the frogui_theme line of multicore.opt"""
+    opt = (REPO_DIR / 'sdcard' / 'configs' / 'multicore.opt').read_text()
+    values = re.search(r'\[frogui_theme\]\s*:\[[^\]]*\]\s*:\[([^\]]*)\]', opt).group(1)
+    return values.split('|')
+
+def write_thumbnail(path):
+    """A simple 160x160 RGB565 gradient"""
+    data = bytearray()
+    for y in range(160):
+        for x in range(160):
+            pixel = ((x * 31 // 159) << 11) | ((y * 63 // 159) << 5) | 16
+            data += pixel.to_bytes(2, 'little')
+    path.write_bytes(data)
+
+def make_fixture(root, theme, font):
+    """Fresh SD card for one run, with theme and font set in the configs"""
+    if root.exists():
+        shutil.rmtree(root)
+    for folder, files in LIBRARY.items():
+        (root / 'ROMS' / folder).mkdir(parents=True)
+        for name in files:
+            (root / 'ROMS' / folder / name).touch()
+    res_dir = root / 'ROMS' / THUMBNAIL[0] / '.res'
+    res_dir.mkdir()
+    write_thumbnail(res_dir / (THUMBNAIL[1] + '.rgb565'))
+
+    opt = (REPO_DIR / 'sdcard' / 'configs' / 'multicore.opt').read_text()
+    opt = re.sub(r'^frogui_theme = ".*"$', f'frogui_theme = "{theme}"', opt, flags=re.M)
+    opt = re.sub(r'^frogui_font = ".*"$', f'frogui_font = "{font}"', opt, flags=re.M)
+    for path in ('configs/multicore.opt', 'default_configs/multicore.opt', 'configs/frogui/FrogUI.opt'):
+        (root / path).parent.mkdir(parents=True, exist_ok=True)
+        (root / path).write_text(opt)
+
+    # The settings screen's file also has an empty and an unquoted setting
+    # line right before option lines, which must still parse
+    lines = opt.splitlines(keepends=True)
+    lines.insert(1, 'sf2000_show_fps = false\n')
+    lines.insert(0, 'frogui_unset = ""\n')
+    (root / 'configs/frogui/FrogUI.opt').write_text(''.join(lines))
+    (root / 'frogui').mkdir()
+
+def render_screen(root, tokens, image):
+    """Run one screen, returning (checksum, microseconds for the last button)"""
+    extra = ['p' + str(image)] if image else []
+    cmd = [str(FRONTEND), '-r', str(root), '-t', str(CORE)] + tokens + ['.'] + extra
+    result = subprocess.run(cmd, cwd=REPO_DIR, capture_output=True, text=True)
+    if result.returncode != 0:
+        print(result.stderr)
+        sys.exit(1)
+
+    checksum, last_us = None, 0
+    for line in result.stdout.splitlines():
+        match = TOKEN_LINE.match(line)
+        # Waits after the last button only animate, they don't redraw the screen
+        if match and not (match.group(1).startswith('w') and last_us):
+            last_us = int(match.group(2))
+        elif CHECKSUM_LINE.match(line):
+            checksum = line
+    return checksum, last_us
+
+def load_golden():
+    golden = {}
+    if GOLDEN_FILE.exists():
+        for line in GOLDEN_FILE.read_text().splitlines():
+            if line and not line.startswith('#'):
+                theme, font, screen, checksum = line.split('\t')
+                golden[(theme, font, screen)] = checksum
+    return golden
+
+def save_golden(results):
+    lines = ['# Golden frame checksums for scripts/golden_frames.py',
+             '# theme<TAB>font<TAB>screen<TAB>checksum']
+    for (theme, font, screen), checksum in results.items():
+        lines.append(f"{theme}\t{font}\t{screen}\t{checksum}")
+    GOLDEN_FILE.write_text('\n'.join(lines) + '\n')
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare FrogUI screens with the golden frames")
+    parser.add_argument('-u', '--update', action='store_true', help="record the current frames as golden")
+    parser.add_argument('--images', help="also write every screen to DIR as a PPM image")
+    parser.add_argument('--theme', help="only check this theme")
+    args = parser.parse_args()
+
+    if not FRONTEND.exists() or not CORE.exists():
+        print("Error: build the core and frontend first with `make host`")
+        sys.exit(1)
+    if args.update and args.theme:
+        print("Error: --update records every theme, don't combine it with --theme")
+        sys.exit(1)
+
+    runs = [(theme, DEFAULT_FONT) for theme in theme_names()]
+    runs += [(DEFAULT_THEME, font) for font in EXTRA_FONTS]
+    if args.theme:
+        runs = [run for run in runs if run[0] == args.theme]
+        if not runs:
+            print(f"Error: unknown theme '{args.theme}'")
+            sys.exit(1)
+
+    images = Path(args.images) if args.images else None
+    if images:
+        images.mkdir(parents=True, exist_ok=True)
+
+    golden = load_golden()
+    results = {}
+    times = {screen: [] for screen, _ in SCREENS}
+    failures = 0
+
+    with tempfile.TemporaryDirectory(prefix='frogui_golden_') as work:
+        root = Path(work) / 'sda1'
+        for theme, font in runs:
+            for screen, tokens in SCREENS:
+                make_fixture(root, theme, font)
+                slug = re.sub(r'[^a-z0-9]+', '_', f"{theme}_{font}_{screen}".lower())
+                image = images / f"{slug}.ppm" if images else None
+                checksum, us = render_screen(root, tokens, image)
+
+                key = (theme, font, screen)
+                results[key] = checksum
+                times[screen].append(us)
+                if not args.update and golden.get(key) != checksum:
+                    failures += 1
+                    print(f"DIFF {theme} / {font} / {screen}: {checksum}, golden {golden.get(key, 'missing')}")
+
+    print(f"{'screen':<10} {'avg (us)':>9} {'max (us)':>9}")
+    for screen, values in times.items():
+        print(f"{screen:<10} {sum(values) // len(values):>9} {max(values):>9}")
+    print()
+
+    if args.update:
+        save_golden(results)
+        print(f"Recorded {len(results)} golden frames in {GOLDEN_FILE.name}")
+    elif failures:
+        print(f"{failures} of {len(results)} screens differ from the golden frames")
+        sys.exit(1)
+    else:
+        print(f"All {len(results)} screens match the golden frames")
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,494 @@
+/*
+ * Minimal headless libretro frontend for running FrogUI on the build machine
+ * Usage: host_frontend [options] <menu_libretro.so> [script...]
+ *
+ * Host tool - build it with `make host` from the repository root.
+ *
+ * The core's absolute SD card paths (/mnt/sda1/...) are redirected to the
+ * directory given with -r, which should look like an SD card root (ROMS/,
+ * configs/, frogui/). Core variables are read from <root>/configs/multicore.opt
+ * like the device does, and -V can override them.
+ *
+ * Script tokens, run in order after the first frame:
+ *   U D L R A B X Y S T l r   press and release a button (S = select, T = start)
+ *   wN                        run N frames with no input
+ *   .                         print a checksum of the current frame
+ *   pFILE                     write the current frame to FILE as a PPM image
+ *
+ * Every retro_run() is timed. A summary is printed at exit, and -t also
+ * prints the time taken by each script token. File system calls made by the
+ * core are counted and the heap in use is sampled after every frame, so the
+ * summary also reports I/O call counts and the peak heap, along with the
+ * audio frames the core sent per video frame.
+ */
+
+#define _GNU_SOURCE
+#include "../libretro.h"
+#include <dirent.h>
+#include <dlfcn.h>
+#include <malloc.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SD_PREFIX "/mnt/sda1"
+#define FRAME_WIDTH 320
+#define FRAME_HEIGHT 240
+#define MAX_VARIABLES 64
+
+// Path redirection
+
+static const char *sd_root = NULL;
+
+// Map /mnt/sda1/... into the fixture directory. Uses a small ring of
+// buffers so a call can map two paths (rename).
+static const char *map_path(const char *path) {
+    static char buffers[4][1024];
+    static int next = 0;
+
+    if (!sd_root || !path || strncmp(path, SD_PREFIX, strlen(SD_PREFIX)) != 0) {
+        return path;
+    }
+
+    char *buffer = buffers[next++ & 3];
+    snprintf(buffer, sizeof(buffers[0]), "%s%s", sd_root, path + strlen(SD_PREFIX));
+    return buffer;
+}
+
+// File system call counters, indexed by IO_*. Only calls made while the
+// core is running are counted, not the frontend's own script and PPM files.
+enum { IO_FOPEN, IO_OPENDIR, IO_READDIR, IO_STAT, IO_ACCESS, IO_WRITE, IO_COUNT };
+static const char *io_names[IO_COUNT] = { "fopen", "opendir", "readdir", "stat", "access", "write" };
+static long io_calls[IO_COUNT];
+static int in_core = 0;
+
+static long io_total(void) {
+    long total = 0;
+    for (int i = 0; i < IO_COUNT; i++) total += io_calls[i];
+    return total;
+}
+
+// These definitions interpose the libc functions the core uses for file
+// access. The frontend is linked with -rdynamic, so the dlopen'ed core binds
+// to them instead of libc; each one maps the path and forwards to libc.
+#define REAL(name) static __typeof__(name) *real_##name; \
+    if (!real_##name) real_##name = (__typeof__(name) *)dlsym(RTLD_NEXT, #name)
+
+FILE *fopen(const char *path, const char *mode) {
+    REAL(fopen);
+    io_calls[IO_FOPEN] += in_core;
+    return real_fopen(map_path(path), mode);
+}
+
+DIR *opendir(const char *path) {
+    REAL(opendir);
+    io_calls[IO_OPENDIR] += in_core;
+    return real_opendir(map_path(path));
+}
+
+struct dirent *readdir(DIR *dir) {
+    REAL(readdir);
+    io_calls[IO_READDIR] += in_core;
+    return real_readdir(dir);
+}
+
+int stat(const char *path, struct stat *st) {
+    REAL(stat);
+    io_calls[IO_STAT] += in_core;
+    return real_stat(map_path(path), st);
+}
+
+int access(const char *path, int mode) {
+    REAL(access);
+    io_calls[IO_ACCESS] += in_core;
+    return real_access(map_path(path), mode);
+}
+
+int rename(const char *old_path, const char *new_path) {
+    REAL(rename);
+    io_calls[IO_WRITE] += in_core;
+    return real_rename(map_path(old_path), map_path(new_path));
+}
+
+int remove(const char *path) {
+    REAL(remove);
+    io_calls[IO_WRITE] += in_core;
+    return real_remove(map_path(path));
+}
+
+int mkdir(const char *path, mode_t mode) {
+    REAL(mkdir);
+    io_calls[IO_WRITE] += in_core;
+    return real_mkdir(map_path(path), mode);
+}
+
+// Core variables
+
+static struct {
+    char key[64];
+    char value[128];
+} variables[MAX_VARIABLES];
+static int variable_count = 0;
+
+static void set_variable(const char *key, const char *value) {
+    int i;
+    for (i = 0; i < variable_count; i++) {
+        if (strcmp(variables[i].key, key) == 0) break;
+    }
+    if (i == variable_count) {
+        if (variable_count == MAX_VARIABLES) return;
+        variable_count++;
+    }
+    snprintf(variables[i].key, sizeof(variables[i].key), "%s", key);
+    snprintf(variables[i].value, sizeof(variables[i].value), "%s", value);
+}
+
+// Read `name = "value"` lines the way multicore does
+static void load_variables(const char *opt_path) {
+    FILE *fp = fopen(opt_path, "r");
+    if (!fp) return;
+
+    char line[512];
+    while (fgets(line, sizeof(line), fp)) {
+        if (line[0] == '#') continue;
+
+        char key[64], value[128];
+        if (sscanf(line, " %63[^ =] = \"%127[^\"]\"", key, value) == 2) {
+            set_variable(key, value);
+        }
+    }
+    fclose(fp);
+}
+
+// Libretro callbacks
+
+static const uint16_t *last_frame = NULL;
+static int16_t buttons[16];
+
+static bool environment(unsigned cmd, void *data) {
+    switch (cmd) {
+        case RETRO_ENVIRONMENT_GET_VARIABLE: {
+            struct retro_variable *var = (struct retro_variable*)data;
+            for (int i = 0; i < variable_count; i++) {
+                if (strcmp(variables[i].key, var->key) == 0) {
+                    var->value = variables[i].value;
+                    return true;
+                }
+            }
+            var->value = NULL;
+            return false;
+        }
+        case RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE:
+            *(bool*)data = false;
+            return true;
+        case RETRO_ENVIRONMENT_SET_PIXEL_FORMAT:
+            return *(enum retro_pixel_format*)data == RETRO_PIXEL_FORMAT_RGB565;
+        case RETRO_ENVIRONMENT_SET_SUPPORT_NO_GAME:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static void video_refresh(const void *data, unsigned width, unsigned height, size_t pitch) {
+    if (data && width == FRAME_WIDTH && height == FRAME_HEIGHT && pitch == FRAME_WIDTH * 2) {
+        last_frame = (const uint16_t*)data;
+    }
+}
+
+static int16_t input_state(unsigned port, unsigned device, unsigned index, unsigned id) {
+    (void)index;
+    if (port != 0 || device != RETRO_DEVICE_JOYPAD || id >= 16) return 0;
+    return buttons[id];
+}
+
+static void input_poll(void) {
+}
+
+static long audio_frames = 0;
+
+static size_t audio_sample_batch(const int16_t *data, size_t frames) {
+    (void)data;
+    audio_frames += frames;
+    return frames;
+}
+
+static void audio_sample(int16_t left, int16_t right) {
+    (void)left;
+    (void)right;
+}
+
+// Frame output
+
+static uint32_t frame_checksum(void) {
+    // FNV-1a over the pixels
+    uint32_t hash = 2166136261u;
+    for (int i = 0; last_frame && i < FRAME_WIDTH * FRAME_HEIGHT; i++) {
+        hash = (hash ^ last_frame[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static int write_ppm(const char *path) {
+    if (!last_frame) return 0;
+
+    FILE *fp = fopen(path, "wb");
+    if (!fp) return 0;
+
+    fprintf(fp, "P6\n%d %d\n255\n", FRAME_WIDTH, FRAME_HEIGHT);
+    for (int i = 0; i < FRAME_WIDTH * FRAME_HEIGHT; i++) {
+        uint16_t c = last_frame[i];
+        unsigned char rgb[3] = {
+            (unsigned char)(((c >> 11) & 0x1F) * 255 / 31),
+            (unsigned char)(((c >> 5) & 0x3F) * 255 / 63),
+            (unsigned char)((c & 0x1F) * 255 / 31)
+        };
+        fwrite(rgb, 1, 3, fp);
+    }
+    fclose(fp);
+    return 1;
+}
+
+// Timing
+
+static void (*core_run)(void);
+static const char *dump_dir = NULL;
+static long frame_count = 0;
+static double total_us = 0, max_us = 0;
+static long max_frame = 0;
+static size_t peak_heap = 0;
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static size_t heap_in_use(void) {
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+// Run one frame, returning how long retro_run() took
+static double run_frame(void) {
+    double start = now_us();
+    in_core = 1;
+    core_run();
+    in_core = 0;
+    double elapsed = now_us() - start;
+
+    size_t heap = heap_in_use();
+    if (heap > peak_heap) peak_heap = heap;
+
+    total_us += elapsed;
+    if (elapsed > max_us) {
+        max_us = elapsed;
+        max_frame = frame_count;
+    }
+
+    if (dump_dir) {
+        char path[1024];
+        snprintf(path, sizeof(path), "%s/frame_%06ld.ppm", dump_dir, frame_count);
+        write_ppm(path);
+    }
+
+    frame_count++;
+    return elapsed;
+}
+
+static int button_for_token(char c) {
+    switch (c) {
+        case 'U': return RETRO_DEVICE_ID_JOYPAD_UP;
+        case 'D': return RETRO_DEVICE_ID_JOYPAD_DOWN;
+        case 'L': return RETRO_DEVICE_ID_JOYPAD_LEFT;
+        case 'R': return RETRO_DEVICE_ID_JOYPAD_RIGHT;
+        case 'A': return RETRO_DEVICE_ID_JOYPAD_A;
+        case 'B': return RETRO_DEVICE_ID_JOYPAD_B;
+        case 'X': return RETRO_DEVICE_ID_JOYPAD_X;
+        case 'Y': return RETRO_DEVICE_ID_JOYPAD_Y;
+        case 'S': return RETRO_DEVICE_ID_JOYPAD_SELECT;
+        case 'T': return RETRO_DEVICE_ID_JOYPAD_START;
+        case 'l': return RETRO_DEVICE_ID_JOYPAD_L;
+        case 'r': return RETRO_DEVICE_ID_JOYPAD_R;
+        default: return -1;
+    }
+}
+
+// Run one script token. Returns 0 on an unknown token.
+static int run_token(const char *token, int print_timing) {
+    double elapsed = 0;
+    int frames = 0;
+    long io_before = io_total();
+    int button = token[1] == '\0' ? button_for_token(token[0]) : -1;
+
+    if (button >= 0) {
+        // Held for one frame, released on the next (FrogUI acts on release)
+        buttons[button] = 1;
+        elapsed += run_frame();
+        buttons[button] = 0;
+        elapsed += run_frame();
+        frames = 2;
+    } else if (token[0] == 'w') {
+        frames = atoi(token + 1);
+        for (int i = 0; i < frames; i++) {
+            elapsed += run_frame();
+        }
+    } else if (strcmp(token, ".") == 0) {
+        printf("%08x\n", (unsigned)frame_checksum());
+        return 1;
+    } else if (token[0] == 'p' && token[1]) {
+        if (!write_ppm(token + 1)) {
+            fprintf(stderr, "Error: cannot write '%s'\n", token + 1);
+        }
+        return 1;
+    } else {
+        return 0;
+    }
+
+    if (print_timing) {
+        printf("%-8s %4d frames %10.0f us %8ld io %8zu KB heap\n",
+               token, frames, elapsed, io_total() - io_before, heap_in_use() / 1024);
+    }
+    return 1;
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+            "Usage: %s [options] <menu_libretro.so> [script...]\n"
+            "  -r DIR        SD card root that replaces /mnt/sda1 (required)\n"
+            "  -f FILE       read script tokens from FILE (after any on the command line)\n"
+            "  -V KEY=VALUE  override a core variable\n"
+            "  -d DIR        dump every frame to DIR/frame_NNNNNN.ppm\n"
+            "  -t            print the time taken by each script token\n",
+            argv0);
+}
+
+int main(int argc, char **argv) {
+    const char *script_file = NULL;
+    int print_timing = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "r:f:V:d:t")) != -1) {
+        switch (opt) {
+            case 'r': sd_root = optarg; break;
+            case 'f': script_file = optarg; break;
+            case 'd': dump_dir = optarg; break;
+            case 't': print_timing = 1; break;
+            case 'V': {
+                char *eq = strchr(optarg, '=');
+                if (!eq) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                *eq = '\0';
+                set_variable(optarg, eq + 1);
+                *eq = '=';
+                break;
+            }
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (!sd_root || optind >= argc) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    // Variables from the SD card first, then the -V overrides on top
+    struct { char key[64]; char value[128]; } overrides[MAX_VARIABLES];
+    int override_count = variable_count;
+    memcpy(overrides, variables, sizeof(overrides[0]) * override_count);
+    variable_count = 0;
+    load_variables(SD_PREFIX "/configs/multicore.opt");
+    for (int i = 0; i < override_count; i++) {
+        set_variable(overrides[i].key, overrides[i].value);
+    }
+
+    void *core = dlopen(argv[optind], RTLD_NOW);
+    if (!core) {
+        fprintf(stderr, "Error: %s\n", dlerror());
+        return 1;
+    }
+
+    void (*set_environment)(retro_environment_t) = dlsym(core, "retro_set_environment");
+    void (*set_video_refresh)(retro_video_refresh_t) = dlsym(core, "retro_set_video_refresh");
+    void (*set_input_state)(retro_input_state_t) = dlsym(core, "retro_set_input_state");
+    void (*set_input_poll)(retro_input_poll_t) = dlsym(core, "retro_set_input_poll");
+    void (*set_audio_sample_batch)(retro_audio_sample_batch_t) = dlsym(core, "retro_set_audio_sample_batch");
+    void (*set_audio_sample)(retro_audio_sample_t) = dlsym(core, "retro_set_audio_sample");
+    void (*core_init)(void) = dlsym(core, "retro_init");
+    void (*core_deinit)(void) = dlsym(core, "retro_deinit");
+    core_run = dlsym(core, "retro_run");
+
+    if (!set_environment || !set_video_refresh || !set_input_state || !set_input_poll ||
+        !set_audio_sample_batch || !set_audio_sample || !core_init || !core_deinit || !core_run) {
+        fprintf(stderr, "Error: '%s' is not a libretro core\n", argv[optind]);
+        return 1;
+    }
+
+    set_environment(environment);
+    set_video_refresh(video_refresh);
+    set_input_state(input_state);
+    set_input_poll(input_poll);
+    set_audio_sample_batch(audio_sample_batch);
+    set_audio_sample(audio_sample);
+
+    double init_start = now_us();
+    in_core = 1;
+    core_init();
+    in_core = 0;
+    double init_us = now_us() - init_start;
+    long init_io = io_total();
+    run_frame();
+
+    for (int i = optind + 1; i < argc; i++) {
+        if (!run_token(argv[i], print_timing)) {
+            fprintf(stderr, "Error: unknown script token '%s'\n", argv[i]);
+            return 1;
+        }
+    }
+
+    if (script_file) {
+        FILE *fp = fopen(script_file, "r");
+        if (!fp) {
+            fprintf(stderr, "Error: cannot read '%s'\n", script_file);
+            return 1;
+        }
+        char token[1024];
+        while (fscanf(fp, "%1023s", token) == 1) {
+            if (!run_token(token, print_timing)) {
+                fprintf(stderr, "Error: unknown script token '%s'\n", token);
+                fclose(fp);
+                return 1;
+            }
+        }
+        fclose(fp);
+    }
+
+    in_core = 1;
+    core_deinit();
+    in_core = 0;
+
+    fprintf(stderr, "init %.0f us, %ld frames, avg %.0f us, max %.0f us (frame %ld)\n",
+            init_us, frame_count, frame_count ? total_us / frame_count : 0.0, max_us, max_frame);
+
+    fprintf(stderr, "io %ld calls (%ld in init):", io_total(), init_io);
+    for (int i = 0; i < IO_COUNT; i++) {
+        fprintf(stderr, " %s %ld", io_names[i], io_calls[i]);
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    fprintf(stderr, "\nheap peak %zu KB, max rss %ld KB\n", peak_heap / 1024, usage.ru_maxrss);
+    fprintf(stderr, "audio %ld frames, %.2f per frame\n", audio_frames,
+            frame_count ? (double)audio_frames / frame_count : 0.0);
+
+    dlclose(core);
+    return 0;
+}
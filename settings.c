@@ -2,10 +2,13 @@
 #include "theme.h"
 #include "font.h"
 #include "frogos.h"
+#include "profile.h"
+#include "vfs.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <sys/stat.h>
 
 #ifdef SF2000
 #include "../../debug.h"
@@ -14,13 +17,70 @@
 #define xlog printf
 #endif
 
-static SettingsOption settings[MAX_SETTINGS];
-static int settings_count = 0;
+#define OPTION_HASH_BUCKETS 256
+
+// A parsed .opt file
+typedef struct {
+    // The file as read, kept unmodified so saves can rewrite it from memory
+    char *text;
+    int text_len;
+
+    // A copy of the file that names and values are NUL-terminated in. Each
+    // option's value list is only split when it's first needed; the table
+    // then holds the values' offsets, indexed by the option's first_value.
+    char *pool;
+    int *value_offsets;
+    int value_offset_count;
+    int value_offset_capacity;
+
+    SettingsOption *options;
+    int count;
+    int capacity;
+
+    // Option name hash (chained through hash_next, -1 terminated)
+    int16_t buckets[OPTION_HASH_BUCKETS];
+    int16_t *hash_next;
+} SettingsFile;
+
+// A setting line seen before its option's ### line
+typedef struct {
+    const char *name;
+    const char *value;
+    int line_start;
+    int line_end;
+} PendingValue;
+
+// Parsed settings files kept between visits to a settings menu. A slot
+// remembers where the file was found (so the directory casing isn't probed
+// again); reopening the menu only stats the file and reuses the slot if its
+// mtime and size still match.
+#define SETTINGS_CACHE_SLOTS 4
+
+typedef struct {
+    char key[64];        // Core name, or "multicore"
+    char path[512];      // Resolved .opt path
+    time_t mtime;
+    off_t size;
+    uint32_t last_used;
+    SettingsFile file;   // Parsed while file.text is set
+} SettingsCacheSlot;
+
+static SettingsCacheSlot settings_cache[SETTINGS_CACHE_SLOTS];
+static uint32_t settings_cache_clock = 0;
+
+// The file the menu shows, always a cache slot's once anything is loaded
+static SettingsFile no_settings;
+static SettingsFile *loaded = &no_settings;
+static int loaded_slot = -1;
+
 static int settings_active = 0;
 static int settings_selected = 0;
 static int settings_scroll_offset = 0;
 static int settings_saving = 0;  // Flag to indicate save in progress
 
+// Set by a reset to defaults, so the next save reapplies everything
+static int settings_reapply_pending = 0;
+
 // Track current config file being edited
 static char current_config_path[512] = "";
 
@@ -30,113 +90,281 @@ static const char* get_config_directory(void) {
 }
 
 // Forward declarations
-static int settings_load_file(const char *config_path);
+static int settings_load_file(SettingsFile *file, const char *config_path);
+static int parse_settings_text(SettingsFile *file, char *text, int length);
 static void apply_theme_from_settings(void);
 static void apply_font_from_settings(void);
+static void apply_profile_from_settings(void);
+
+// FNV-1a hash of an option name, reduced to a bucket
+static int option_bucket(const char *name) {
+    uint32_t hash = 2166136261u;
+    for (const char *p = name; *p; p++) {
+        hash = (hash ^ (unsigned char)*p) * 16777619u;
+    }
+    return hash & (OPTION_HASH_BUCKETS - 1);
+}
+
+// Index of the option with this name in a file, or -1
+static int find_option(const SettingsFile *file, const char *name) {
+    if (file->count == 0) return -1;
+
+    for (int i = file->buckets[option_bucket(name)]; i >= 0; i = file->hash_next[i]) {
+        if (strcmp(file->options[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+// Append a value to a file's value table, growing it as needed
+static int add_value(SettingsFile *file, const char *value) {
+    if (file->value_offset_count == file->value_offset_capacity) {
+        int capacity = file->value_offset_capacity ? file->value_offset_capacity * 2 : 256;
+        int *grown = (int*)realloc(file->value_offsets, capacity * sizeof(int));
+        if (!grown) return 0;
+        file->value_offsets = grown;
+        file->value_offset_capacity = capacity;
+    }
+
+    file->value_offsets[file->value_offset_count++] = value - file->pool;
+    return 1;
+}
+
+// Room for one more option, growing the option table as needed
+static SettingsOption* new_option(SettingsFile *file) {
+    if (file->count == file->capacity) {
+        int capacity = file->capacity ? file->capacity * 2 : 32;
+        SettingsOption *options = (SettingsOption*)realloc(file->options, capacity * sizeof(SettingsOption));
+        if (!options) return NULL;
+        file->options = options;
+
+        int16_t *hash_next = (int16_t*)realloc(file->hash_next, capacity * sizeof(int16_t));
+        if (!hash_next) return NULL;
+        file->hash_next = hash_next;
+        file->capacity = capacity;
+    }
+    return &file->options[file->count];
+}
+
+static void settings_file_free(SettingsFile *file) {
+    free(file->text);
+    free(file->pool);
+    free(file->value_offsets);
+    free(file->options);
+    free(file->hash_next);
+    memset(file, 0, sizeof(*file));
+}
+
+// Slot for a key, or -1
+static int cache_find(const char *key) {
+    for (int i = 0; i < SETTINGS_CACHE_SLOTS; i++) {
+        if (settings_cache[i].key[0] && strcmp(settings_cache[i].key, key) == 0) return i;
+    }
+    return -1;
+}
+
+// Slot for a new key, evicting the least recently used one other than the
+// file on screen
+static int cache_claim(const char *key, const char *path) {
+    int index = -1;
+    for (int i = 0; i < SETTINGS_CACHE_SLOTS; i++) {
+        if (i == loaded_slot) continue;
+        if (index < 0 || settings_cache[i].last_used < settings_cache[index].last_used) index = i;
+    }
+
+    SettingsCacheSlot *slot = &settings_cache[index];
+    settings_file_free(&slot->file);
+    snprintf(slot->key, sizeof(slot->key), "%s", key);
+    snprintf(slot->path, sizeof(slot->path), "%s", path);
+    return index;
+}
+
+// Remember the mtime and size a slot's file was parsed at
+static void cache_stamp(int index) {
+    SettingsCacheSlot *slot = &settings_cache[index];
+    struct stat st;
+
+    if (vfs_stat(slot->path, &st) != 0) {
+        settings_file_free(&slot->file);
+        return;
+    }
+    slot->mtime = st.st_mtime;
+    slot->size = st.st_size;
+}
+
+// Check that a slot's parsed file still matches the card
+static int cache_validate(int index) {
+    SettingsCacheSlot *slot = &settings_cache[index];
+    struct stat st;
+
+    if (!slot->file.text) return 0;
+    if (vfs_stat(slot->path, &st) != 0) {
+        // The file is gone, so forget where it was too
+        settings_file_free(&slot->file);
+        slot->key[0] = '\0';
+        return 0;
+    }
+    if (st.st_mtime != slot->mtime || st.st_size != slot->size) {
+        settings_file_free(&slot->file);
+        return 0;
+    }
+
+    // Drop values changed in a menu that was left without saving
+    for (int i = 0; i < slot->file.count; i++) {
+        SettingsOption *option = &slot->file.options[i];
+        option->current_index = option->saved_index;
+        option->current_value = option->saved_value;
+    }
+    return 1;
+}
+
+// Load a settings file through the cache. path is NULL when the file's
+// location isn't known yet; resolve_path then finds it.
+static int settings_load_cached(const char *key, const char *path, int (*resolve_path)(const char *key, char *path)) {
+    int index = cache_find(key);
+    if (index >= 0) {
+        if (!cache_validate(index) && !settings_cache[index].key[0]) index = -1;
+    }
+
+    if (index < 0) {
+        char resolved[512];
+        if (!path) {
+            if (!resolve_path(key, resolved)) return 0;
+            path = resolved;
+        }
+        index = cache_claim(key, path);
+    }
+
+    SettingsCacheSlot *slot = &settings_cache[index];
+    slot->last_used = ++settings_cache_clock;
+    if (!slot->file.text) {
+        if (settings_load_file(&slot->file, slot->path) == 0) return 0;
+        cache_stamp(index);
+    }
+
+    snprintf(current_config_path, sizeof(current_config_path), "%s", slot->path);
+    loaded = &slot->file;
+    loaded_slot = index;
+    return loaded->count;
+}
 
 void settings_init(void) {
-    settings_count = 0;
+    loaded = &no_settings;
+    loaded_slot = -1;
     settings_active = 0;
     settings_selected = 0;
     settings_scroll_offset = 0;
 }
 
 // Parse a line like: ### [option_name] :[current] :[val1|val2|val3]
-static int parse_option_line(const char *line, SettingsOption *option) {
-    if (strncmp(line, "### [", 5) != 0) return 0;
+// The name and current value are NUL-terminated in place; the value list
+// is only located here and split by option_values().
+static int parse_option_line(SettingsFile *file, char *line, char *line_end, SettingsOption *option) {
+    if (line_end - line < 5 || strncmp(line, "### [", 5) != 0) return 0;
 
     // Find option name
-    const char *name_start = line + 5;
-    const char *name_end = strchr(name_start, ']');
+    char *name_start = line + 5;
+    char *name_end = memchr(name_start, ']', line_end - name_start);
     if (!name_end) return 0;
 
     int name_len = name_end - name_start;
     if (name_len >= MAX_OPTION_NAME_LEN) return 0;
 
-    strncpy(option->name, name_start, name_len);
-    option->name[name_len] = '\0';
-
     // Find current value (between first : and next ])
-    const char *current_start = strchr(name_end, ':');
+    char *current_start = memchr(name_end, ':', line_end - name_end);
     if (!current_start) return 0;
     current_start++; // Skip ':'
 
     // Skip whitespace and '[' if present
-    while (*current_start == ' ' || *current_start == '\t' || *current_start == '[') current_start++;
+    while (current_start < line_end && (*current_start == ' ' || *current_start == '\t' || *current_start == '[')) {
+        current_start++;
+    }
 
-    const char *current_end = strchr(current_start, ']');
+    char *current_end = memchr(current_start, ']', line_end - current_start);
     if (!current_end) return 0;
 
+    // Find possible values (between [ and last ])
+    char *values_start = memchr(current_end, '[', line_end - current_end);
+    if (!values_start) return 0;
+    values_start++; // Skip '['
+
+    // Find the LAST ']' on the line (not the first one)
+    char *values_end = line_end;
+    while (values_end > values_start && *(values_end - 1) != ']') values_end--;
+    if (values_end == values_start) return 0;
+    values_end--;
+
     // Trim trailing whitespace from current value
     while (current_end > current_start && (*(current_end - 1) == ' ' || *(current_end - 1) == '\t')) {
         current_end--;
     }
+    if (current_end == current_start) return 0;
 
-    int current_len = current_end - current_start;
-    if (current_len >= MAX_OPTION_VALUE_LEN || current_len <= 0) return 0;
-
-    strncpy(option->current_value, current_start, current_len);
-    option->current_value[current_len] = '\0';
-
-    // Find possible values (between [ and last ])
-    const char *values_start = strchr(current_end, '[');
-    if (!values_start) return 0;
-    values_start++; // Skip '['
+    memcpy(option->name, name_start, name_len);
+    option->name[name_len] = '\0';
+    *current_end = '\0';
+    option->current_value = current_start;
+    option->saved_value = current_start;
+    option->values_start = values_start - file->pool;
+    option->values_end = values_end - file->pool;
+    option->first_value = 0;
+    option->value_count = -1;
+    option->current_index = 0;
+    option->saved_index = 0;
+    option->line_start = -1;
+    option->line_end = -1;
+    return 1;
+}
 
-    // Find the LAST ']' on the line (not the first one)
-    const char *values_end = strrchr(values_start, ']');
-    if (!values_end) return 0;
+// Split an option's value list on first use, returning the value count
+static int option_values(SettingsFile *file, SettingsOption *option) {
+    if (option->value_count >= 0) return option->value_count;
 
-    // Parse pipe-separated values
+    option->first_value = file->value_offset_count;
     option->value_count = 0;
     option->current_index = 0;
 
-    char values_str[16384];  // Increased to 16KB to handle large palette lists
-    int values_len = values_end - values_start;
-    if (values_len >= (int)sizeof(values_str)) return 0;
-    
-    strncpy(values_str, values_start, values_len);
-    values_str[values_len] = '\0';
-    
-    char *token = strtok(values_str, "|");
-    while (token && option->value_count < MAX_OPTION_VALUES) {
-        // Trim leading whitespace
-        while (*token == ' ' || *token == '\t') token++;
-
-        // Trim trailing whitespace
-        char *end = token + strlen(token) - 1;
-        while (end > token && (*end == ' ' || *end == '\t')) {
-            *end = '\0';
-            end--;
+    char *token = file->pool + option->values_start;
+    char *values_end = file->pool + option->values_end;
+    while (token < values_end) {
+        char *token_end = memchr(token, '|', values_end - token);
+        if (!token_end) token_end = values_end;
+        char *next = token_end + 1;
+
+        // Trim whitespace; empty values are skipped
+        while (token < token_end && (*token == ' ' || *token == '\t')) token++;
+        while (token_end > token && (*(token_end - 1) == ' ' || *(token_end - 1) == '\t')) token_end--;
+
+        if (token_end > token) {
+            *token_end = '\0';
+            if (!add_value(file, token)) break;
+
+            // Check if this is the current value
+            if (strcmp(token, option->current_value) == 0) {
+                option->current_index = option->value_count;
+                option->current_value = token;
+            }
+            option->value_count++;
         }
+        token = next;
+    }
 
-        strncpy(option->possible_values[option->value_count], token, MAX_OPTION_VALUE_LEN - 1);
-        option->possible_values[option->value_count][MAX_OPTION_VALUE_LEN - 1] = '\0';
-
-        // Check if this is the current value
-        if (strcmp(token, option->current_value) == 0) {
-            option->current_index = option->value_count;
-        }
+    option->saved_index = option->current_index;
+    option->saved_value = option->current_value;
+    return option->value_count;
+}
 
-        option->value_count++;
-        token = strtok(NULL, "|");
-    }
-    
-    return 1;
+const char* settings_get_option_value(const SettingsOption *option, int index) {
+    if (!option || index < 0 || index >= option->value_count) return NULL;
+    return loaded->pool + loaded->value_offsets[option->first_value + index];
 }
 
 int settings_load(void) {
-    char config_path[512];
-
     // Use standard location: /mnt/sda1/configs/multicore.opt
-    snprintf(config_path, sizeof(config_path), "/mnt/sda1/configs/multicore.opt");
-    strncpy(current_config_path, config_path, sizeof(current_config_path) - 1);
-    return settings_load_file(config_path);
+    return settings_load_cached("multicore", "/mnt/sda1/configs/multicore.opt", NULL);
 }
 
-// Load core-specific settings
-int settings_load_core(const char *core_name) {
-    char config_path[512];
+// Find a core's .opt file, which may be in a lowercase or capitalized folder
+static int resolve_core_config_path(const char *core_name, char *config_path) {
     char core_name_lower[256];
 
     // Create lowercase version of core name
@@ -151,320 +379,346 @@ int settings_load_core(const char *core_name) {
     const char *base_dir = get_config_directory();
 
     // Try lowercase directory name first: /mnt/sda1/configs/{core_lower}/{core}.opt
-    snprintf(config_path, sizeof(config_path), "%s/%s/%s.opt", base_dir, core_name_lower, core_name);
-    FILE *test = fopen(config_path, "r");
-    if (test) {
-        fclose(test);
-        strncpy(current_config_path, config_path, sizeof(current_config_path) - 1);
-        return settings_load_file(config_path);
-    }
+    snprintf(config_path, 512, "%s/%s/%s.opt", base_dir, core_name_lower, core_name);
+    if (vfs_access(config_path, R_OK) == 0) return 1;
 
     // Try capitalized directory name: /mnt/sda1/configs/{core}/{core}.opt
-    snprintf(config_path, sizeof(config_path), "%s/%s/%s.opt", base_dir, core_name, core_name);
-    strncpy(current_config_path, config_path, sizeof(current_config_path) - 1);
-    return settings_load_file(config_path);
+    snprintf(config_path, 512, "%s/%s/%s.opt", base_dir, core_name, core_name);
+    return vfs_access(config_path, R_OK) == 0;
+}
+
+// Load core-specific settings
+int settings_load_core(const char *core_name) {
+    return settings_load_cached(core_name, NULL, resolve_core_config_path);
+}
+
+// Set an option's current value from its setting line
+static void set_current_value(SettingsOption *option, const char *value, int line_start, int line_end) {
+    option->current_value = value;
+    option->saved_value = value;
+    option->line_start = line_start;
+    option->line_end = line_end;
+}
+
+// Double the room for setting lines seen before their options
+static int grow_pending(PendingValue **pending, int *capacity) {
+    int grown_capacity = *capacity ? *capacity * 2 : 32;
+    PendingValue *grown = (PendingValue*)realloc(*pending, grown_capacity * sizeof(PendingValue));
+    if (!grown) return 0;
+    *pending = grown;
+    *capacity = grown_capacity;
+    return 1;
 }
 
 // Common settings loading function
-static int settings_load_file(const char *config_path) {
-    FILE *fp = fopen(config_path, "rb");
+static int settings_load_file(SettingsFile *file, const char *config_path) {
+    FILE *fp = vfs_fopen(config_path, "rb");
     if (!fp) {
         return 0;
     }
 
     // Read entire file into memory to bypass FILE buffering issues
-    fseek(fp, 0, SEEK_END);
-    long file_size = ftell(fp);
-    fseek(fp, 0, SEEK_SET);
+    vfs_fseek(fp, 0, SEEK_END);
+    long file_size = vfs_ftell(fp);
+    vfs_fseek(fp, 0, SEEK_SET);
 
     char *file_contents = (char*)malloc(file_size + 1);
     if (!file_contents) {
-        fclose(fp);
+        vfs_fclose(fp);
         return 0;
     }
 
-    size_t bytes_read = fread(file_contents, 1, file_size, fp);
+    size_t bytes_read = vfs_fread(file_contents, 1, file_size, fp);
     file_contents[bytes_read] = '\0';
-    fclose(fp);
+    vfs_fclose(fp);
+
+    return parse_settings_text(file, file_contents, bytes_read);
+}
 
-    char line[16384];
-    settings_count = 0;
+// Parse a loaded .opt file into file, taking ownership of the text
+// (allocated with room for a terminator)
+static int parse_settings_text(SettingsFile *file, char *text, int length) {
+    settings_file_free(file);
+    file->text = text;
+    file->text_len = length;
+    file->pool = (char*)malloc(length + 1);
+    if (!file->pool) {
+        settings_file_free(file);
+        return 0;
+    }
+    memcpy(file->pool, text, length);
+    file->pool[length] = '\0';
+    memset(file->buckets, -1, sizeof(file->buckets));
 
-    // Parse lines from memory
-    char *line_start = file_contents;
-    char *line_end;
+    PendingValue *pending = NULL;
+    int pending_count = 0;
+    int pending_capacity = 0;
 
-    while (line_start < file_contents + bytes_read && settings_count < MAX_SETTINGS) {
+    // One pass over the file, tokenizing each line in place
+    char *pool = file->pool;
+    char *file_end = pool + length;
+    char *line_start = pool;
+    while (line_start < file_end) {
         // Find end of line
-        line_end = line_start;
-        while (line_end < file_contents + bytes_read && *line_end != '\n' && *line_end != '\r') {
+        char *line_end = line_start;
+        while (line_end < file_end && *line_end != '\n' && *line_end != '\r') {
             line_end++;
         }
 
-        // Copy line to buffer
-        int line_len = line_end - line_start;
-        if (line_len > 0 && line_len < (int)sizeof(line)) {
-            memcpy(line, line_start, line_len);
-            line[line_len] = '\0';
-
-            // Parse comment lines that define options
-            if (parse_option_line(line, &settings[settings_count])) {
-                settings_count++;
-            }
-        }
-
-        // Skip past line ending characters (\r, \n, or \r\n)
-        while (line_end < file_contents + bytes_read && (*line_end == '\n' || *line_end == '\r')) {
-            line_end++;
+        // Skip past line ending characters (\r, \n, or \r\n) before the line
+        // is tokenized, since a value that runs to the end of the line is
+        // terminated on its line ending
+        char *next_line = line_end;
+        while (next_line < file_end && (*next_line == '\n' || *next_line == '\r')) {
+            next_line++;
         }
-        line_start = line_end;
-    }
 
-    // Second pass: parse actual current values from setting lines
-    line_start = file_contents;
-    while (line_start < file_contents + bytes_read && settings_count < MAX_SETTINGS) {
-        // Find end of line
-        line_end = line_start;
-        while (line_end < file_contents + bytes_read && *line_end != '\n' && *line_end != '\r') {
-            line_end++;
-        }
+        if (strncmp(line_start, "###", 3) == 0) {
+            // Comment lines that define options
+            SettingsOption *option = new_option(file);
+            if (option && file->count < INT16_MAX && parse_option_line(file, line_start, line_end, option)) {
+                if (find_option(file, option->name) < 0) {
+                    int bucket = option_bucket(option->name);
+                    file->hash_next[file->count] = file->buckets[bucket];
+                    file->buckets[bucket] = file->count;
+                }
+                file->count++;
 
-        // Copy line to buffer
-        int line_len = line_end - line_start;
-        if (line_len > 0 && line_len < (int)sizeof(line)) {
-            memcpy(line, line_start, line_len);
-            line[line_len] = '\0';
-
-            // Skip comment lines
-            if (strncmp(line, "###", 3) != 0) {
-                // Parse setting lines (option_name = "value")
-                char *equals = strchr(line, '=');
-                if (equals) {
-                    *equals = '\0';
-                    char *option_name = line;
-                    char *value_start = equals + 1;
-
-                    // Trim whitespace from option name
-                    while (*option_name == ' ' || *option_name == '\t') option_name++;
-                    char *end = option_name + strlen(option_name) - 1;
-                    while (end > option_name && (*end == ' ' || *end == '\t')) end--;
-                    *(end + 1) = '\0';
-
-                    // Trim whitespace and quotes from value
-                    while (*value_start == ' ' || *value_start == '\t' || *value_start == '"') value_start++;
-                    end = value_start + strlen(value_start) - 1;
-                    while (end > value_start && (*end == ' ' || *end == '\t' || *end == '"')) end--;
-                    *(end + 1) = '\0';
-
-                    // Find matching option and update its current value
-                    for (int i = 0; i < settings_count; i++) {
-                        if (strcmp(settings[i].name, option_name) == 0) {
-                            strncpy(settings[i].current_value, value_start, MAX_OPTION_VALUE_LEN - 1);
-                            settings[i].current_value[MAX_OPTION_VALUE_LEN - 1] = '\0';
-
-                            // Update current_index to match the new value
-                            for (int j = 0; j < settings[i].value_count; j++) {
-                                if (strcmp(settings[i].possible_values[j], value_start) == 0) {
-                                    settings[i].current_index = j;
-                                    break;
-                                }
-                            }
-                            break;
-                        }
+                // Take a value whose setting line came first
+                for (int i = 0; i < pending_count; i++) {
+                    if (strcmp(pending[i].name, option->name) == 0) {
+                        set_current_value(option, pending[i].value, pending[i].line_start, pending[i].line_end);
+                        pending[i] = pending[--pending_count];
+                        break;
                     }
                 }
             }
+        } else {
+            // Setting lines (option_name = "value")
+            char *equals = memchr(line_start, '=', line_end - line_start);
+            if (equals) {
+                char *option_name = line_start;
+                char *value_start = equals + 1;
+
+                // Trim whitespace from option name
+                while (option_name < equals && (*option_name == ' ' || *option_name == '\t')) option_name++;
+                char *end = equals;
+                while (end > option_name && (*(end - 1) == ' ' || *(end - 1) == '\t')) end--;
+                *end = '\0';
+
+                // Trim whitespace and quotes from value
+                while (value_start < line_end && (*value_start == ' ' || *value_start == '\t' || *value_start == '"')) value_start++;
+                end = line_end;
+                while (end > value_start && (*(end - 1) == ' ' || *(end - 1) == '\t' || *(end - 1) == '"')) end--;
+                *end = '\0';
+
+                // Find matching option and update its current value
+                int index = find_option(file, option_name);
+                if (index >= 0) {
+                    set_current_value(&file->options[index], value_start, line_start - pool, line_end - pool);
+                } else if (pending_count < pending_capacity || grow_pending(&pending, &pending_capacity)) {
+                    pending[pending_count].name = option_name;
+                    pending[pending_count].value = value_start;
+                    pending[pending_count].line_start = line_start - pool;
+                    pending[pending_count].line_end = line_end - pool;
+                    pending_count++;
+                }
+            }
         }
 
-        // Skip past line ending characters
-        while (line_end < file_contents + bytes_read && (*line_end == '\n' || *line_end == '\r')) {
-            line_end++;
-        }
-        line_start = line_end;
+        line_start = next_line;
     }
 
-    free(file_contents);
-
-    return settings_count;
+    free(pending);
+    return file->count;
 }
 
-int settings_save(void) {
-    settings_saving = 1;  // Set saving flag to prevent premature exit
-
-    // Use the current config path that was set during load
-    const char *config_path = current_config_path;
-    char temp_path[512];
-    snprintf(temp_path, sizeof(temp_path), "%s.tmp", config_path);
+// Write a whole file, returning 0 on any error
+static int write_file(const char *path, const char *data, int length) {
+    FILE *fp = vfs_fopen(path, "wb");
+    if (!fp) return 0;
 
-    FILE *fp_read = fopen(config_path, "r");
-    if (!fp_read) {
-        settings_saving = 0;
-        return 0;
-    }
+    int ok = (int)vfs_fwrite(data, 1, length, fp) == length;
 
-    // Create temporary file
-    FILE *fp_write = fopen(temp_path, "w");
-    if (!fp_write) {
-        fclose(fp_read);
-        settings_saving = 0;
-        return 0;
-    }
+    // Flush to ensure data is written to disk
+    if (ok && vfs_fflush(fp) != 0) ok = 0;
+    vfs_fclose(fp);
+    return ok;
+}
 
-    char line[512];
-    int write_error = 0;
+// Append a setting line to a buffer
+static int format_setting_line(char *out, const SettingsOption *option) {
+    const char *value = settings_get_option_value(option, option->current_index);
+    return sprintf(out, "%s = \"%s\"", option->name, value ? value : "");
+}
 
-    while (fgets(line, sizeof(line), fp_read)) {
-        // Check if this is a config line (not comment)
-        if (strncmp(line, "###", 3) == 0) {
-            // Keep comment lines as-is
-            if (fputs(line, fp_write) == EOF) {
-                write_error = 1;
-                break;
-            }
-        } else {
-            // Check if this is a setting we need to update
-            char *equals = strchr(line, '=');
-            if (equals) {
-                *equals = '\0';
-                char *option_name = line;
-
-                // Trim whitespace
-                while (*option_name == ' ' || *option_name == '\t') option_name++;
-                char *end = option_name + strlen(option_name) - 1;
-                while (end > option_name && (*end == ' ' || *end == '\t')) end--;
-                *(end + 1) = '\0';
-
-                // Find matching setting
-                int found = 0;
-                for (int i = 0; i < settings_count; i++) {
-                    if (strcmp(settings[i].name, option_name) == 0) {
-                        if (fprintf(fp_write, "%s = \"%s\"\n", option_name,
-                                   settings[i].possible_values[settings[i].current_index]) < 0) {
-                            write_error = 1;
-                            break;
-                        }
-                        found = 1;
-                        break;
-                    }
-                }
+// Whether an option was changed since the file was parsed. Options whose
+// values were never split can't have been.
+static int option_changed(const SettingsOption *option) {
+    return option->value_count >= 0 && option->current_index != option->saved_index;
+}
 
-                if (write_error) break;
+int settings_save(void) {
+    // Count the changed options and the room their lines need
+    int changed_count = 0;
+    int theme_changed = settings_reapply_pending;
+    int font_changed = settings_reapply_pending;
+    int profile_changed = settings_reapply_pending;
+    int extra_bytes = 0;
+
+    for (int i = 0; i < loaded->count; i++) {
+        const SettingsOption *option = &loaded->options[i];
+        if (!option_changed(option)) continue;
+
+        const char *value = settings_get_option_value(option, option->current_index);
+        extra_bytes += strlen(option->name) + (value ? strlen(value) : 0) + 8;
+        changed_count++;
+
+        if (strcmp(option->name, "frogui_theme") == 0) theme_changed = 1;
+        if (strcmp(option->name, "frogui_font") == 0) font_changed = 1;
+        if (strcmp(option->name, "frogui_show_frametime") == 0) profile_changed = 1;
+    }
+
+    if (changed_count > 0) {
+        settings_saving = 1;  // Set saving flag to prevent premature exit
+
+        // Rewrite the loaded file in memory, replacing the setting lines of
+        // changed options in file order. Options without a setting line
+        // are appended.
+        char *text = (char*)malloc(loaded->text_len + extra_bytes + 2);
+        if (!text) {
+            settings_saving = 0;
+            return 0;
+        }
 
-                if (!found) {
-                    // Restore original line
-                    *equals = '=';
-                    if (fputs(line, fp_write) == EOF) {
-                        write_error = 1;
-                        break;
-                    }
-                    // Make sure line has newline
-                    if (!strchr(line, '\n')) {
-                        if (fputc('\n', fp_write) == EOF) {
-                            write_error = 1;
-                            break;
-                        }
-                    }
-                }
-            } else {
-                if (fputs(line, fp_write) == EOF) {
-                    write_error = 1;
-                    break;
-                }
-                // Make sure line has newline
-                if (!strchr(line, '\n')) {
-                    if (fputc('\n', fp_write) == EOF) {
-                        write_error = 1;
-                        break;
-                    }
+        int length = 0;
+        int copied = 0;
+        while (1) {
+            const SettingsOption *next = NULL;
+            for (int i = 0; i < loaded->count; i++) {
+                const SettingsOption *option = &loaded->options[i];
+                if (option_changed(option) && option->line_start >= copied &&
+                    (!next || option->line_start < next->line_start)) {
+                    next = option;
                 }
             }
-        }
-    }
+            if (!next) break;
 
-    fclose(fp_read);
-
-    // Flush to ensure data is written to disk
-    if (!write_error) {
-        if (fflush(fp_write) != 0) {
-            write_error = 1;
+            memcpy(text + length, loaded->text + copied, next->line_start - copied);
+            length += next->line_start - copied;
+            length += format_setting_line(text + length, next);
+            copied = next->line_end;
         }
-    }
+        memcpy(text + length, loaded->text + copied, loaded->text_len - copied);
+        length += loaded->text_len - copied;
 
-    fclose(fp_write);
+        for (int i = 0; i < loaded->count; i++) {
+            const SettingsOption *option = &loaded->options[i];
+            if (!option_changed(option) || option->line_start >= 0) continue;
 
-    // If there was a write error, remove temp file and abort
-    if (write_error) {
-        remove(temp_path);
-        settings_saving = 0;
-        return 0;
-    }
-
-    // Atomically replace original file with temp file using rename
-    // This is atomic on most filesystems and safer than copying
-    if (rename(temp_path, config_path) != 0) {
-        // If rename fails, fall back to copy method
-        FILE *src = fopen(temp_path, "r");
-        FILE *dst = fopen(config_path, "w");
-
-        if (src && dst) {
-            char buffer[1024];
-            size_t bytes;
-            int copy_error = 0;
-            while ((bytes = fread(buffer, 1, sizeof(buffer), src)) > 0) {
-                if (fwrite(buffer, 1, bytes, dst) != bytes) {
-                    copy_error = 1;
-                    break;
-                }
-            }
+            if (length > 0 && text[length - 1] != '\n') text[length++] = '\n';
+            length += format_setting_line(text + length, option);
+            text[length++] = '\n';
+        }
 
-            if (!copy_error) {
-                fflush(dst);
+        // Use the current config path that was set during load
+        const char *config_path = current_config_path;
+        char temp_path[sizeof(current_config_path) + 4];  // The path and ".tmp"
+        snprintf(temp_path, sizeof(temp_path), "%s.tmp", config_path);
+
+        // Write a temporary file and atomically replace the original with
+        // it, writing the original directly if the rename fails
+        int saved = 0;
+        if (write_file(temp_path, text, length)) {
+            if (vfs_rename(temp_path, config_path) == 0) {
+                saved = 1;
+            } else if (write_file(config_path, text, length)) {
+                vfs_remove(temp_path);
+                saved = 1;
             }
+        }
 
-            fclose(src);
-            fclose(dst);
-
-            if (!copy_error) {
-                remove(temp_path);
-            } else {
-                settings_saving = 0;
-                return 0;
-            }
-        } else {
-            if (src) fclose(src);
-            if (dst) fclose(dst);
+        if (!saved) {
+            vfs_remove(temp_path);
+            free(text);
             settings_saving = 0;
             return 0;
         }
-    }
 
-    settings_saving = 0;
+        // The new text is what's on the card now
+        parse_settings_text(loaded, text, length);
+        if (loaded_slot >= 0) cache_stamp(loaded_slot);
+        settings_saving = 0;
+    }
 
     // Apply theme and font changes after saving settings
-    // Workaround because RETRO_ENVIRONMENT_GET_VARIABLE isn't updated 
-    apply_theme_from_settings();
-    apply_font_from_settings();
+    // Workaround because RETRO_ENVIRONMENT_GET_VARIABLE isn't updated
+    if (theme_changed) apply_theme_from_settings();
+    if (font_changed) apply_font_from_settings();
+    if (profile_changed) apply_profile_from_settings();
+    settings_reapply_pending = 0;
 
     return 1;
 }
 
 int settings_get_count(void) {
-    return settings_count;
+    return loaded->count;
 }
 
 const SettingsOption* settings_get_option(int index) {
-    if (index < 0 || index >= settings_count) return NULL;
-    return &settings[index];
+    if (index < 0 || index >= loaded->count) return NULL;
+
+    // Options are shown a page at a time, so this is where their value
+    // lists get split
+    option_values(loaded, &loaded->options[index]);
+    return &loaded->options[index];
+}
+
+// Move an option to its next or previous value
+static void step_option(int index, int step) {
+    if (index < 0 || index >= loaded->count) return;
+
+    SettingsOption *option = &loaded->options[index];
+    int count = option_values(loaded, option);
+    if (count == 0) return;
+
+    option->current_index = (option->current_index + step + count) % count;
+    option->current_value = settings_get_option_value(option, option->current_index);
 }
 
 void settings_cycle_option(int index) {
-    if (index < 0 || index >= settings_count) return;
-    
-    settings[index].current_index = (settings[index].current_index + 1) % settings[index].value_count;
-    strncpy(settings[index].current_value, 
-           settings[index].possible_values[settings[index].current_index], 
-           MAX_OPTION_VALUE_LEN - 1);
-    settings[index].current_value[MAX_OPTION_VALUE_LEN - 1] = '\0';
+    step_option(index, 1);
+}
+
+// Options are grouped by the part of their name before the first '_',
+// e.g. sf2000_ or frogui_
+static int same_category(const SettingsOption *a, const SettingsOption *b) {
+    const char *a_end = strchr(a->name, '_');
+    const char *b_end = strchr(b->name, '_');
+    int a_len = a_end ? a_end - a->name : (int)strlen(a->name);
+    int b_len = b_end ? b_end - b->name : (int)strlen(b->name);
+    return a_len == b_len && strncmp(a->name, b->name, a_len) == 0;
+}
+
+// First option of the category after (or before) the selected one, wrapping
+static int category_jump(int selected, int forward) {
+    const SettingsOption *options = loaded->options;
+    int count = loaded->count;
+
+    if (forward) {
+        int i = selected;
+        while (i < count && same_category(&options[i], &options[selected])) i++;
+        return i < count ? i : 0;
+    }
+
+    // Start of the current category, or of the previous one if already there
+    int start = selected;
+    while (start > 0 && same_category(&options[start - 1], &options[selected])) start--;
+    if (start != selected) return start;
+
+    int last = (start > 0 ? start : count) - 1;
+    while (last > 0 && same_category(&options[last - 1], &options[last])) last--;
+    return last;
 }
 
 void settings_show_menu(void) {
@@ -473,7 +727,7 @@ void settings_show_menu(void) {
     settings_scroll_offset = 0;
 }
 
-int settings_handle_input(int up, int down, int left, int right, int a, int b, int y) {
+int settings_handle_input(int up, int down, int left, int right, int l, int r, int a, int b, int y) {
     if (!settings_active) return 0;
 
     // Don't allow any input while saving is in progress
@@ -485,7 +739,7 @@ int settings_handle_input(int up, int down, int left, int right, int a, int b, i
         if (settings_selected > 0) {
             settings_selected--;
         } else {
-            settings_selected = settings_count - 1;
+            settings_selected = loaded->count - 1;
         }
 
         // Adjust scroll offset
@@ -498,7 +752,7 @@ int settings_handle_input(int up, int down, int left, int right, int a, int b, i
     }
 
     if (down) {
-        if (settings_selected < settings_count - 1) {
+        if (settings_selected < loaded->count - 1) {
             settings_selected++;
         } else {
             settings_selected = 0;
@@ -521,12 +775,18 @@ int settings_handle_input(int up, int down, int left, int right, int a, int b, i
 
     if (left) {
         // Cycle to previous value
-        if (settings_selected >= 0 && settings_selected < settings_count) {
-            SettingsOption *option = &settings[settings_selected];
-            option->current_index = (option->current_index - 1 + option->value_count) % option->value_count;
-            strncpy(option->current_value, option->possible_values[option->current_index], MAX_OPTION_VALUE_LEN - 1);
-            option->current_value[MAX_OPTION_VALUE_LEN - 1] = '\0';
+        step_option(settings_selected, -1);
+        return 1;
+    }
+
+    if ((l || r) && loaded->count > 0) {
+        // Jump to the previous or next category, shown from the top
+        settings_selected = category_jump(settings_selected, r);
+        settings_scroll_offset = settings_selected;
+        if (settings_scroll_offset > loaded->count - max_visible) {
+            settings_scroll_offset = loaded->count - max_visible;
         }
+        if (settings_scroll_offset < 0) settings_scroll_offset = 0;
         return 1;
     }
 
@@ -574,34 +834,33 @@ int settings_get_scroll_offset(void) {
 
 // Apply theme changes from loaded settings
 static void apply_theme_from_settings(void) {
-    // Look for the frogui_theme setting
-    for (int i = 0; i < settings_count; i++) {
-        if (strcmp(settings[i].name, "frogui_theme") == 0) {
-            theme_load_from_settings(settings[i].current_value);
-            break;
-        }
+    const char *value = settings_get_value("frogui_theme");
+    if (value) {
+        theme_load_from_settings(value);
     }
 }
 
 // Apply font changes from loaded settings
 static void apply_font_from_settings(void) {
-    // Look for the frogui_font setting
-    for (int i = 0; i < settings_count; i++) {
-        if (strcmp(settings[i].name, "frogui_font") == 0) {
-            font_load_from_settings(settings[i].current_value);
-            break;
-        }
+    const char *value = settings_get_value("frogui_font");
+    if (value) {
+        font_load_from_settings(value);
+    }
+}
+
+// Apply the frame time overlay and I/O log setting from loaded settings
+static void apply_profile_from_settings(void) {
+    const char *value = settings_get_value("frogui_show_frametime");
+    if (value) {
+        profile_set_enabled(strcmp(value, "true") == 0);
+        vfs_set_logging(strcmp(value, "true") == 0);
     }
 }
 
 // Get setting value by name
 const char* settings_get_value(const char *setting_name) {
-    for (int i = 0; i < settings_count; i++) {
-        if (strcmp(settings[i].name, setting_name) == 0) {
-            return settings[i].current_value;
-        }
-    }
-    return NULL;
+    int index = find_option(loaded, setting_name);
+    return index >= 0 ? loaded->options[index].current_value : NULL;
 }
 
 // Get default configs directory - always use /mnt/sda1/default_configs
@@ -645,15 +904,15 @@ int settings_reset_to_defaults(void) {
         snprintf(default_path, sizeof(default_path), "%s/%s/%s.opt", default_base, core_name, core_name);
     }
 
-    FILE *default_file = fopen(default_path, "r");
+    FILE *default_file = vfs_fopen(default_path, "r");
     if (!default_file) {
         settings_saving = 0;
         return 0;
     }
 
-    FILE *dest_file = fopen(current_config_path, "w");
+    FILE *dest_file = vfs_fopen(current_config_path, "w");
     if (!dest_file) {
-        fclose(default_file);
+        vfs_fclose(default_file);
         settings_saving = 0;
         return 0;
     }
@@ -662,20 +921,20 @@ int settings_reset_to_defaults(void) {
     char buffer[1024];
     size_t bytes;
     int copy_error = 0;
-    while ((bytes = fread(buffer, 1, sizeof(buffer), default_file)) > 0) {
-        if (fwrite(buffer, 1, bytes, dest_file) != bytes) {
+    while ((bytes = vfs_fread(buffer, 1, sizeof(buffer), default_file)) > 0) {
+        if (vfs_fwrite(buffer, 1, bytes, dest_file) != bytes) {
             copy_error = 1;
             break;
         }
     }
 
-    fclose(default_file);
+    vfs_fclose(default_file);
 
-    if (!copy_error && fflush(dest_file) != 0) {
+    if (!copy_error && vfs_fflush(dest_file) != 0) {
         copy_error = 1;
     }
 
-    fclose(dest_file);
+    vfs_fclose(dest_file);
 
     if (copy_error) {
         settings_saving = 0;
@@ -685,7 +944,9 @@ int settings_reset_to_defaults(void) {
     settings_saving = 0;
 
     // Reload settings from the reset file
-    settings_load_file(current_config_path);
+    settings_load_file(loaded, current_config_path);
+    if (loaded_slot >= 0) cache_stamp(loaded_slot);
+    settings_reapply_pending = 1;
 
     // Reset UI state
     settings_selected = 0;
@@ -3,18 +3,26 @@
 
 #include <stdint.h>
 
-#define MAX_SETTINGS 32
 #define MAX_OPTION_NAME_LEN 64
-#define MAX_OPTION_VALUE_LEN 48
-#define MAX_OPTION_VALUES 128
 
-// Settings option structure
+// Settings option structure. Values point into the loaded file,
+// so there is no cap on the number of options or on the number or length
+// of their values; use settings_get_option_value() to read one. An
+// option's value list is only split when the option is first returned by
+// settings_get_option() (value_count is -1 until then). The pointers stay
+// valid until the file is reloaded or saved.
 typedef struct {
     char name[MAX_OPTION_NAME_LEN];
-    char current_value[MAX_OPTION_VALUE_LEN];
-    char possible_values[MAX_OPTION_VALUES][MAX_OPTION_VALUE_LEN];
+    const char *current_value;
+    const char *saved_value;  // current_value as loaded
+    int values_start;  // Offsets of the value list in the loaded file
+    int values_end;
+    int first_value;   // Index of this option's first value in the shared value table
     int value_count;
     int current_index;
+    int saved_index;   // current_index as loaded, to tell whether the option changed
+    int line_start;    // Offsets of the option's setting line in the loaded file (-1 if none)
+    int line_end;
 } SettingsOption;
 
 // Initialize settings system
@@ -26,7 +34,8 @@ int settings_load(void);
 // Load core-specific settings (e.g., Gambatte.opt)
 int settings_load_core(const char *core_name);
 
-// Save settings to multicore.opt
+// Save changed settings back to the loaded file (nothing is written if no
+// option changed)
 int settings_save(void);
 
 // Get settings count
@@ -35,14 +44,17 @@ int settings_get_count(void);
 // Get settings option by index
 const SettingsOption* settings_get_option(int index);
 
+// Get one of an option's possible values (NULL if index is out of range)
+const char* settings_get_option_value(const SettingsOption *option, int index);
+
 // Set option to next value (cycles through possible values)
 void settings_cycle_option(int index);
 
 // Show settings menu
 void settings_show_menu(void);
 
-// Handle settings menu input
-int settings_handle_input(int up, int down, int left, int right, int a, int b, int y);
+// Handle settings menu input (l and r jump between option categories)
+int settings_handle_input(int up, int down, int left, int right, int l, int r, int a, int b, int y);
 
 // Check if we're in settings mode
 int settings_is_active(void);
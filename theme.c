@@ -1,5 +1,6 @@
 #include "theme.h"
 #include "settings.h"
+#include "font.h"
 #include <string.h>
 
 const Theme themes[] = {
@@ -395,6 +396,13 @@ void theme_apply(int theme_index) {
     if (theme_index >= 0 && theme_index < theme_count) {
         current_theme_index = theme_index;
         current_theme = &themes[theme_index];
+
+        // Build the text blend tables now rather than on the first frame
+        font_prepare_color(current_theme->text);
+        font_prepare_color(current_theme->select_text);
+        font_prepare_color(current_theme->header);
+        font_prepare_color(current_theme->folder);
+        font_prepare_color(current_theme->legend);
     }
 }
 
@@ -0,0 +1,185 @@
+#include "vfs.h"
+#include <stdarg.h>
+#include <string.h>
+#include <unistd.h>
+
+static const char *action_names[VFS_ACTION_COUNT] = {
+    "boot", "move", "enter", "settings", "favorite", "launch", "music"
+};
+
+static const char *op_names[VFS_OP_COUNT] = {
+    "open", "read", "write", "seek", "close", "opendir", "readdir", "stat", "modify"
+};
+
+static VfsAction current_action = VFS_ACTION_BOOT;
+static VfsStats current;
+static VfsStats last[VFS_ACTION_COUNT];
+static VfsStats *counted = &current;  // current, or the music's last[] entry
+static int logging_enabled = 0;
+
+static void count_op(VfsOp op) {
+    counted->calls[op]++;
+}
+
+// Files
+
+FILE *vfs_fopen(const char *path, const char *mode) {
+    count_op(VFS_OP_OPEN);
+    return fopen(path, mode);
+}
+
+int vfs_fclose(FILE *fp) {
+    count_op(VFS_OP_CLOSE);
+    return fclose(fp);
+}
+
+size_t vfs_fread(void *buffer, size_t size, size_t count, FILE *fp) {
+    count_op(VFS_OP_READ);
+    size_t items = fread(buffer, size, count, fp);
+    counted->bytes_read += items * size;
+    return items;
+}
+
+size_t vfs_fwrite(const void *buffer, size_t size, size_t count, FILE *fp) {
+    count_op(VFS_OP_WRITE);
+    size_t items = fwrite(buffer, size, count, fp);
+    counted->bytes_written += items * size;
+    return items;
+}
+
+char *vfs_fgets(char *line, int size, FILE *fp) {
+    count_op(VFS_OP_READ);
+    char *result = fgets(line, size, fp);
+    if (result) counted->bytes_read += strlen(result);
+    return result;
+}
+
+int vfs_fputs(const char *text, FILE *fp) {
+    count_op(VFS_OP_WRITE);
+    int result = fputs(text, fp);
+    if (result != EOF) counted->bytes_written += strlen(text);
+    return result;
+}
+
+int vfs_fputc(int c, FILE *fp) {
+    count_op(VFS_OP_WRITE);
+    int result = fputc(c, fp);
+    if (result != EOF) counted->bytes_written++;
+    return result;
+}
+
+int vfs_fprintf(FILE *fp, const char *format, ...) {
+    count_op(VFS_OP_WRITE);
+    va_list args;
+    va_start(args, format);
+    int result = vfprintf(fp, format, args);
+    va_end(args);
+    if (result > 0) counted->bytes_written += result;
+    return result;
+}
+
+int vfs_fflush(FILE *fp) {
+    count_op(VFS_OP_WRITE);
+    return fflush(fp);
+}
+
+int vfs_fseek(FILE *fp, long offset, int whence) {
+    count_op(VFS_OP_SEEK);
+    return fseek(fp, offset, whence);
+}
+
+long vfs_ftell(FILE *fp) {
+    count_op(VFS_OP_SEEK);
+    return ftell(fp);
+}
+
+// Directories and metadata
+
+DIR *vfs_opendir(const char *path) {
+    count_op(VFS_OP_OPENDIR);
+    return opendir(path);
+}
+
+struct dirent *vfs_readdir(DIR *dir) {
+    count_op(VFS_OP_READDIR);
+    return readdir(dir);
+}
+
+int vfs_closedir(DIR *dir) {
+    count_op(VFS_OP_CLOSE);
+    return closedir(dir);
+}
+
+int vfs_stat(const char *path, struct stat *st) {
+    count_op(VFS_OP_STAT);
+    return stat(path, st);
+}
+
+int vfs_access(const char *path, int mode) {
+    count_op(VFS_OP_STAT);
+    return access(path, mode);
+}
+
+int vfs_rename(const char *old_path, const char *new_path) {
+    count_op(VFS_OP_MODIFY);
+    return rename(old_path, new_path);
+}
+
+int vfs_remove(const char *path) {
+    count_op(VFS_OP_MODIFY);
+    return remove(path);
+}
+
+// Action accounting
+
+// One line per action with the non-zero counters. Uses stdio directly so
+// the log's own writes aren't counted.
+static void log_action(VfsAction action, const VfsStats *stats) {
+    FILE *fp = fopen(VFS_LOG_FILE, "a");
+    if (!fp) return;
+
+    fprintf(fp, "%s: %u calls, %u bytes read, %u bytes written", action_names[action],
+            (unsigned)vfs_total_calls(stats), (unsigned)stats->bytes_read, (unsigned)stats->bytes_written);
+    for (int i = 0; i < VFS_OP_COUNT; i++) {
+        if (stats->calls[i]) fprintf(fp, " %s %u", op_names[i], (unsigned)stats->calls[i]);
+    }
+    fprintf(fp, "\n");
+    fclose(fp);
+}
+
+void vfs_begin_action(VfsAction action) {
+    // An action that touched no files keeps the stats of its last I/O
+    if (vfs_total_calls(&current) > 0) {
+        last[current_action] = current;
+        if (logging_enabled) log_action(current_action, &current);
+    }
+
+    memset(&current, 0, sizeof(current));
+    current_action = action;
+}
+
+void vfs_begin_background(void) {
+    counted = &last[VFS_ACTION_MUSIC];
+}
+
+void vfs_end_background(void) {
+    counted = &current;
+}
+
+const VfsStats *vfs_get_last(VfsAction action) {
+    return &last[action];
+}
+
+uint32_t vfs_total_calls(const VfsStats *stats) {
+    uint32_t total = 0;
+    for (int i = 0; i < VFS_OP_COUNT; i++) total += stats->calls[i];
+    return total;
+}
+
+const char *vfs_action_name(VfsAction action) {
+    return action_names[action];
+}
+
+void vfs_set_logging(int enabled) {
+    logging_enabled = enabled;
+}
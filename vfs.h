@@ -0,0 +1,94 @@
+#ifndef VFS_H
+#define VFS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <sys/stat.h>
+
+#ifdef SF2000
+#include "../../dirent.h"
+#else
+#include <dirent.h>
+#endif
+
+// Thin wrappers over the stdio/dirent calls FrogUI uses for SD card access.
+// Every call is counted, together with the bytes moved, and charged to the
+// user action that caused it, so FAT32 I/O can be measured per action.
+
+#define VFS_LOG_FILE "/mnt/sda1/frogui/io.log"
+
+// User actions I/O is charged to. An action lasts until the next one starts,
+// so the redraw after a button press is counted with that press.
+typedef enum {
+    VFS_ACTION_BOOT,      // retro_init()
+    VFS_ACTION_MOVE,      // Cursor and A-Z picker navigation
+    VFS_ACTION_ENTER,     // Opening or leaving a folder or screen
+    VFS_ACTION_SETTINGS,  // Settings menu
+    VFS_ACTION_FAVORITE,  // Toggling a favorite
+    VFS_ACTION_LAUNCH,    // Queuing a game
+    VFS_ACTION_MUSIC,     // Menu music streaming, never the current action
+    VFS_ACTION_COUNT
+} VfsAction;
+
+typedef enum {
+    VFS_OP_OPEN,      // fopen
+    VFS_OP_READ,      // fread, fgets
+    VFS_OP_WRITE,     // fwrite, fputs, fputc, fprintf, fflush
+    VFS_OP_SEEK,      // fseek, ftell
+    VFS_OP_CLOSE,     // fclose, closedir
+    VFS_OP_OPENDIR,   // opendir
+    VFS_OP_READDIR,   // readdir
+    VFS_OP_STAT,      // stat, access
+    VFS_OP_MODIFY,    // rename, remove
+    VFS_OP_COUNT
+} VfsOp;
+
+typedef struct {
+    uint32_t calls[VFS_OP_COUNT];
+    uint32_t bytes_read;
+    uint32_t bytes_written;
+} VfsStats;
+
+// Files
+FILE *vfs_fopen(const char *path, const char *mode);
+int vfs_fclose(FILE *fp);
+size_t vfs_fread(void *buffer, size_t size, size_t count, FILE *fp);
+size_t vfs_fwrite(const void *buffer, size_t size, size_t count, FILE *fp);
+char *vfs_fgets(char *line, int size, FILE *fp);
+int vfs_fputs(const char *text, FILE *fp);
+int vfs_fputc(int c, FILE *fp);
+int vfs_fprintf(FILE *fp, const char *format, ...) __attribute__((format(printf, 2, 3)));
+int vfs_fflush(FILE *fp);
+int vfs_fseek(FILE *fp, long offset, int whence);
+long vfs_ftell(FILE *fp);
+
+// Directories and metadata
+DIR *vfs_opendir(const char *path);
+struct dirent *vfs_readdir(DIR *dir);
+int vfs_closedir(DIR *dir);
+int vfs_stat(const char *path, struct stat *st);
+int vfs_access(const char *path, int mode);
+int vfs_rename(const char *old_path, const char *new_path);
+int vfs_remove(const char *path);
+
+// Finish the current action and start charging I/O to a new one. The
+// finished action's counters become its "last" stats and, with logging on,
+// are appended to VFS_LOG_FILE if it did any I/O.
+void vfs_begin_action(VfsAction action);
+
+// Menu music streams from the card during every action, so its I/O is
+// counted apart from the actions between these calls. Its counters are a
+// running total since boot, returned by vfs_get_last(VFS_ACTION_MUSIC),
+// and aren't logged.
+void vfs_begin_background(void);
+void vfs_end_background(void);
+
+// Counters of the last finished action of each kind
+const VfsStats *vfs_get_last(VfsAction action);
+uint32_t vfs_total_calls(const VfsStats *stats);
+const char *vfs_action_name(VfsAction action);
+
+// Log every finished action (frogui_show_frametime)
+void vfs_set_logging(int enabled);
+
+#endif // VFS_H